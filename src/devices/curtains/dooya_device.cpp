@@ -112,7 +112,7 @@ std::vector<uint8_t> Dooya::TDevice::ExecCommand(const TRequest& request)
 
 void Dooya::TDevice::WriteRegister(PRegister reg, uint64_t value)
 {
-    switch (reg->Type)
+    switch (reg->GetConfig()->Type)
     {
         case POSITION: {
             if (value == 0) {
@@ -129,7 +129,7 @@ void Dooya::TDevice::WriteRegister(PRegister reg, uint64_t value)
             return;
         }
         case PARAM: {
-            uint8_t dataAddress = GetUint32RegisterAddress(reg->GetAddress());
+            uint8_t dataAddress = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
             TRequest req;
             req.Data = MakeRequest(SlaveId, {WRITE, dataAddress, 1, static_cast<uint8_t>(value)});
             req.ResponseSize = RESPONSE_SIZE;
@@ -139,7 +139,7 @@ void Dooya::TDevice::WriteRegister(PRegister reg, uint64_t value)
             return;
         }
         case COMMAND: {
-            uint8_t dataAddress = GetUint32RegisterAddress(reg->GetAddress());
+            uint8_t dataAddress = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
             TRequest req;
             req.Data = MakeRequest(SlaveId, {CONTROL, dataAddress});
             req.ResponseSize = CONTROL_RESPONSE_SIZE;
@@ -153,13 +153,13 @@ void Dooya::TDevice::WriteRegister(PRegister reg, uint64_t value)
 
 uint64_t Dooya::TDevice::ReadRegister(PRegister reg)
 {
-    switch (reg->Type)
+    switch (reg->GetConfig()->Type)
     {
         case POSITION: {
             return ParsePositionResponse(SlaveId, READ, GET_POSITION_DATA_LENGTH, ExecCommand(GetPositionCommand));
         }
         case PARAM: {
-            auto addr = GetUint32RegisterAddress(reg->GetAddress());
+            auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
             TRequest req;
             req.Data = MakeRequest(SlaveId, {READ, static_cast<uint8_t>(addr & 0xFF), 1});
             req.ResponseSize = RESPONSE_SIZE;
@@ -191,7 +191,7 @@ std::vector<uint8_t> Somfy::TDevice::ExecCommand(const std::vector<uint8_t>& req
 
 void Somfy::TDevice::WriteRegister(PRegister reg, uint64_t value)
 {
-    if (reg->Type == POSITION) {
+    if (reg->GetConfig()->Type == POSITION) {
         if (value == 0) {
             Check(SlaveId, ACK, ExecCommand(CloseCommand));
             return;
@@ -203,14 +203,14 @@ void Somfy::TDevice::WriteRegister(PRegister reg, uint64_t value)
         Check(SlaveId, ACK, ExecCommand(MakeSetPositionRequest(SlaveId, NodeType, value)));
         return;
     }
-    if (reg->Type == COMMAND) {
+    if (reg->GetConfig()->Type == COMMAND) {
         std::vector<uint8_t> data;
         size_t l = (value & 0xFF);
         for (; l != 0; --l) {
             value >>= 8;
             data.push_back(value & 0xFF);
         }
-        auto addr = GetUint32RegisterAddress(reg->GetAddress());
+        auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
         Check(SlaveId, ACK, ExecCommand(MakeRequest(addr, SlaveId, NodeType, data)));
         return;
     }
@@ -236,7 +236,7 @@ uint64_t Somfy::TDevice::GetCachedResponse(uint8_t requestHeader, uint8_t respon
 
 uint64_t Somfy::TDevice::ReadRegister(PRegister reg)
 {
-    switch (reg->Type)
+    switch (reg->GetConfig()->Type)
     {
         case POSITION: {
             auto res = GetCachedResponse(GET_MOTOR_POSITION, POST_MOTOR_POSITION, 2*8, 8);
@@ -246,8 +246,8 @@ uint64_t Somfy::TDevice::ReadRegister(PRegister reg)
             return res;
         }    
         case PARAM: {
-            const auto& addr = dynamic_cast<const TSomfyAddress&>(reg->GetAddress());
-            return GetCachedResponse(addr.Get(), addr.GetResponseHeader(), reg->BitOffset, reg->BitWidth);
+            const auto& addr = dynamic_cast<const TSomfyAddress&>(reg->GetConfig()->GetAddress());
+            return GetCachedResponse(addr.Get(), addr.GetResponseHeader(), reg->GetConfig()->BitOffset, reg->GetConfig()->BitWidth);
         }
         case COMMAND: {
             return 1;
@@ -92,7 +92,7 @@ std::vector<uint8_t> WinDeco::TDevice::ExecCommand(const std::vector<uint8_t>& r
 
 void WinDeco::TDevice::WriteRegister(PRegister reg, uint64_t value)
 {
-    if (reg->Type == POSITION) {
+    if (reg->GetConfig()->Type == POSITION) {
         if (value == 0) {
             CheckCommandResponse(ZoneId, CurtainId, CLOSE_COMMAND, ExecCommand(CloseCommand));
         } else if (value == 100) {
@@ -102,8 +102,8 @@ void WinDeco::TDevice::WriteRegister(PRegister reg, uint64_t value)
         }
         return;
     }
-    if(reg->Type == COMMAND) {
-        uint8_t addr = GetUint32RegisterAddress(reg->GetAddress());
+    if(reg->GetConfig()->Type == COMMAND) {
+        uint8_t addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
         CheckCommandResponse(ZoneId, CurtainId, addr, ExecCommand(MakeRequest(ZoneId, CurtainId, addr)));
         return;
     }
@@ -112,7 +112,7 @@ void WinDeco::TDevice::WriteRegister(PRegister reg, uint64_t value)
 
 uint64_t WinDeco::TDevice::ReadRegister(PRegister reg)
 {
-    switch (reg->Type)
+    switch (reg->GetConfig()->Type)
     {
         case POSITION: return ParsePositionResponse(ZoneId, CurtainId, ExecCommand(GetPositionCommand));
         case PARAM:    return ParseStateResponse(ZoneId, CurtainId, ExecCommand(GetStateCommand));
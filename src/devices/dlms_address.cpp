@@ -0,0 +1,57 @@
+#include "dlms_address.h"
+#include "serial_config.h"
+
+#include <algorithm>
+
+TObisRegisterAddress::TObisRegisterAddress(const std::string& addr) : Address(addr), Column(0)
+{
+    auto parts = WBMQTT::StringSplit(addr, ":");
+    if (parts.size() > 2) {
+        throw TConfigParserException("Bad OBIS code '" + addr + "'");
+    }
+    LogicalName = parts[0];
+    auto bytes = WBMQTT::StringSplit(LogicalName, ".");
+    if (bytes.size() != 6) {
+        throw TConfigParserException("Bad OBIS code '" + addr + "'");
+    }
+    for (const auto& b: bytes) {
+        if (b.empty() || !std::all_of(b.cbegin(), b.cend(), ::isdigit)) {
+            throw TConfigParserException("Bad OBIS code '" + addr + "'");
+        }
+    }
+    if (parts.size() == 2) {
+        if (parts[1].empty() || !std::all_of(parts[1].cbegin(), parts[1].cend(), ::isdigit) || std::stoul(parts[1]) == 0) {
+            throw TConfigParserException("Bad profile column in '" + addr + "'");
+        }
+        Column = std::stoul(parts[1]);
+    }
+}
+
+const std::string& TObisRegisterAddress::GetLogicalName() const
+{
+    return LogicalName;
+}
+
+size_t TObisRegisterAddress::GetColumn() const
+{
+    return Column;
+}
+
+std::string TObisRegisterAddress::ToString() const
+{
+    return Address;
+}
+
+bool TObisRegisterAddress::operator<(const IRegisterAddress& addr) const
+{
+    const auto& a = dynamic_cast<const TObisRegisterAddress&>(addr);
+    return Address < a.Address;
+}
+
+IRegisterAddress* TObisRegisterAddress::CalcNewAddress(uint32_t /*offset*/,
+                                                       uint32_t /*stride*/,
+                                                       uint32_t /*registerByteWidth*/,
+                                                       uint32_t /*addressByteStep*/) const
+{
+    return new TObisRegisterAddress(Address);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "register.h"
+
+//! OBIS code optionally followed by profile column number: "X.X.X.X.X.X" or "X.X.X.X.X.X:N"
+class TObisRegisterAddress: public IRegisterAddress
+{
+    std::string Address;
+    std::string LogicalName;
+    size_t      Column;
+public:
+    //! Throws TConfigParserException if the address is malformed
+    TObisRegisterAddress(const std::string& addr);
+
+    const std::string& GetLogicalName() const;
+
+    //! 1-based column number of profile, 0 if not set
+    size_t GetColumn() const;
+
+    std::string ToString() const override;
+
+    bool operator<(const IRegisterAddress& addr) const override;
+
+    IRegisterAddress* CalcNewAddress(uint32_t offset,
+                                     uint32_t stride,
+                                     uint32_t registerByteWidth,
+                                     uint32_t addressByteStep) const override;
+};
@@ -0,0 +1,149 @@
+#include "dlms_cache.h"
+#include "log.h"
+
+#include <fstream>
+#include <stdio.h>
+#include <wblib/json_utils.h>
+
+#define LOG(logger) ::logger.Log() << "[dlms cache] "
+
+/*
+ * File format:
+ * {
+ *   "meters": {
+ *     "<meter id>": {
+ *       "<logical name>": { "scaler": -3, "unit": 30 },
+ *       ...
+ *     },
+ *     ...
+ *   },
+ *   "profiles": {
+ *     "<profile id>": <time of last read entry, seconds since epoch>,
+ *     ...
+ *   }
+ * }
+ */
+
+TDlmsCache::TDlmsCache(const std::string& fileName)
+    : FileName(fileName),
+      Modified(false)
+{
+    Json::Value root;
+    try {
+        root = WBMQTT::JSON::Parse(FileName);
+    } catch (const std::exception& e) {
+        LOG(Debug) << "Can't load " << FileName << ": " << e.what();
+        return;
+    }
+    if (!root.isObject()) {
+        LOG(Warn) << FileName << " is broken, the cache is dropped";
+        return;
+    }
+    const auto& meters = root["meters"];
+    for (auto meter = meters.begin(); meter != meters.end(); ++meter) {
+        if (!meter->isObject()) {
+            continue;
+        }
+        auto& registers = Meters[meter.name()];
+        for (auto reg = meter->begin(); reg != meter->end(); ++reg) {
+            if ((*reg)["scaler"].isInt() && (*reg)["unit"].isUInt()) {
+                registers[reg.name()] = {static_cast<int8_t>((*reg)["scaler"].asInt()),
+                                         static_cast<uint8_t>((*reg)["unit"].asUInt())};
+            }
+        }
+    }
+    const auto& profiles = root["profiles"];
+    for (auto profile = profiles.begin(); profile != profiles.end(); ++profile) {
+        if (profile->isInt64()) {
+            ProfileTimes[profile.name()] = profile->asInt64();
+        }
+    }
+}
+
+bool TDlmsCache::GetScalerUnit(const std::string& meterId, const std::string& logicalName, TDlmsScalerUnit& value) const
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    auto meter = Meters.find(meterId);
+    if (meter == Meters.end()) {
+        return false;
+    }
+    auto reg = meter->second.find(logicalName);
+    if (reg == meter->second.end()) {
+        return false;
+    }
+    value = reg->second;
+    return true;
+}
+
+void TDlmsCache::SetScalerUnit(const std::string& meterId, const std::string& logicalName, const TDlmsScalerUnit& value)
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    auto& registers = Meters[meterId];
+    auto reg = registers.find(logicalName);
+    if (reg == registers.end()) {
+        registers.insert({logicalName, value});
+        Modified = true;
+    } else if (reg->second.Scaler != value.Scaler || reg->second.Unit != value.Unit) {
+        reg->second = value;
+        Modified = true;
+    }
+}
+
+bool TDlmsCache::GetProfileTime(const std::string& profileId, time_t& value) const
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    auto it = ProfileTimes.find(profileId);
+    if (it == ProfileTimes.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+void TDlmsCache::SetProfileTime(const std::string& profileId, time_t value)
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    auto& time = ProfileTimes[profileId];
+    if (time != value) {
+        time = value;
+        Modified = true;
+    }
+}
+
+void TDlmsCache::Save()
+{
+    std::unique_lock<std::mutex> lock(Mutex);
+    if (!Modified) {
+        return;
+    }
+    Json::Value root(Json::objectValue);
+    for (const auto& meter: Meters) {
+        auto& registers = root["meters"][meter.first];
+        for (const auto& reg: meter.second) {
+            registers[reg.first]["scaler"] = reg.second.Scaler;
+            registers[reg.first]["unit"] = reg.second.Unit;
+        }
+    }
+    for (const auto& profile: ProfileTimes) {
+        root["profiles"][profile.first] = static_cast<Json::Int64>(profile.second);
+    }
+
+    // Write to temporary file and rename it, so the cache isn't broken by power loss
+    auto tmpFileName = FileName + ".tmp";
+    {
+        std::ofstream f(tmpFileName);
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+        writer->write(root, &f);
+        if (!f) {
+            LOG(Warn) << "Can't write " << tmpFileName;
+            return;
+        }
+    }
+    if (rename(tmpFileName.c_str(), FileName.c_str()) < 0) {
+        LOG(Warn) << "Can't rename " << tmpFileName << " to " << FileName;
+        return;
+    }
+    Modified = false;
+}
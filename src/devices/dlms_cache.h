@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct TDlmsScalerUnit
+{
+    int8_t  Scaler; //! Power of ten
+    uint8_t Unit;
+};
+
+/**
+ * @brief Persistent cache of DLMS meters data.
+ *        Keeps static attributes of registers per meter, the meter is identified by logical device address
+ *        and serial number, so replaced meter doesn't get attributes of the old one.
+ *        Also keeps time of last read entry of profiles.
+ *        The cache is shared between devices of all ports, so it is thread safe.
+ */
+class TDlmsCache
+{
+public:
+    //! Loads cache from the file. Missing or broken file gives empty cache
+    explicit TDlmsCache(const std::string& fileName);
+
+    //! Returns false if there is no value in cache
+    bool GetScalerUnit(const std::string& meterId, const std::string& logicalName, TDlmsScalerUnit& value) const;
+
+    void SetScalerUnit(const std::string& meterId, const std::string& logicalName, const TDlmsScalerUnit& value);
+
+    //! Returns false if the profile has not been read yet
+    bool GetProfileTime(const std::string& profileId, time_t& value) const;
+
+    void SetProfileTime(const std::string& profileId, time_t value);
+
+    //! Writes cache to the file if it has been changed since last save
+    void Save();
+
+private:
+    mutable std::mutex                                              Mutex;
+    std::string                                                     FileName;
+    std::map<std::string, std::map<std::string, TDlmsScalerUnit>>   Meters;
+    std::map<std::string, time_t>                                   ProfileTimes;
+    bool                                                            Modified;
+};
@@ -1,6 +1,10 @@
 #include "dlms_device.h"
+#include "dlms_address.h"
+#include "dlms_cache.h"
 #include "log.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 #include "GXDLMSTranslator.h"
@@ -8,14 +12,48 @@
 #include "GXDLMSSapAssignment.h"
 #include "GXDLMSObject.h"
 #include "GXDLMSObjectFactory.h"
+#include "GXDLMSData.h"
+#include "GXDLMSProfileGeneric.h"
 
-#define LOG(logger) ::logger.Log() << "[" << DeviceConfig()->Name << " (" << ToString() << ")] "
+#define LOG(logger) logger.Log() << "[" << DeviceConfig()->Name << " (" << ToString() << ")] "
 
 namespace
 {
     const size_t MAX_PACKET_SIZE = 200;
 
+    // HDLC frame bytes besides information field: flags, frame format, addresses, control, HCS and FCS
+    const size_t HDLC_FRAME_OVERHEAD = 20;
+
+    const uint8_t HDLC_POLL_FINAL_BIT = 0x10;
+
+    // Limits of HDLC parameters from IEC 62056-46
+    const int MIN_HDLC_INFO_SIZE   = 32;
+    const int MAX_HDLC_INFO_SIZE   = 2030;
+    const int MAX_HDLC_WINDOW_SIZE = 7;
+
+    const int DEFAULT_REGISTER_TYPE = 0;
+    const int PROFILE_REGISTER_TYPE = 1;
+
+    const int REGISTER_VALUE_ATTRIBUTE_INDEX = 2;
+    const int PROFILE_BUFFER_ATTRIBUTE_INDEX = 2;
+    const int PROFILE_CAPTURE_OBJECTS_ATTRIBUTE_INDEX = 3;
+    const int PROFILE_CAPTURE_PERIOD_ATTRIBUTE_INDEX = 4;
+
+    //! Maximum number of profile entries requested at once. Small transfers don't delay polling of other registers
+    const int MAX_PROFILE_ENTRIES_PER_READ = 8;
+
+    //! Used if profile capture period is not set
+    const std::chrono::seconds DEFAULT_PROFILE_CAPTURE_PERIOD = std::chrono::minutes(30);
+    const int REGISTER_SCALER_UNIT_ATTRIBUTE_INDEX = 3;
+    const int DATA_VALUE_ATTRIBUTE_INDEX = 2;
+
+    const auto SERIAL_NUMBER_LOGICAL_NAME = "0.0.96.1.0.255";
+
+    //! Maximum number of registers in one range. The range is read by several GET-Request-With-List requests if needed
+    const size_t MAX_REGISTERS_IN_LIST = 32;
+
     const auto OBIS_CODE_HINTS_FULL_FILE_PATH = "/usr/share/wb-mqtt-serial/obis-hints.json";
+    const auto CACHE_FULL_FILE_PATH = "/var/lib/wb-mqtt-serial/dlms-cache.json";
 
     const std::chrono::milliseconds DEFAULT_RESPONSE_TIMEOUT(1000);
     const std::chrono::milliseconds DEFAULT_FRAME_TIMEOUT(20);
@@ -36,48 +74,19 @@ namespace
 
     typedef std::unordered_map<std::string, TObisCodeHint> TObisCodeHints;
 
-    class TObisRegisterAddress: public IRegisterAddress
+    //! The meter has answered with data access result instead of data, e.g. the object is undefined or read is denied
+    class TDlmsDataAccessException: public TSerialDeviceTransientErrorException
     {
-        std::string LogicalName;
     public:
-        TObisRegisterAddress(const std::string& ln) : LogicalName(ln)
-        {
-            auto bytes = WBMQTT::StringSplit(ln, ".");
-            if (bytes.size() != 6) {
-                throw TConfigParserException("Bad OBIS code '" + ln + "'");
-            }
-            for (const auto& b: bytes) {
-                if (!std::all_of(b.cbegin(), b.cend(), ::isdigit)) {
-                    throw TConfigParserException("Bad OBIS code '" + ln + "'");
-                }
-            }
-        }
-
-        const std::string& GetLogicalName() const
-        {
-            return LogicalName;
-        }
-
-        std::string ToString() const override
-        {
-            return LogicalName;
-        }
-
-        bool operator<(const IRegisterAddress& addr) const override
-        {
-            const auto& a = dynamic_cast<const TObisRegisterAddress&>(addr);
-            return LogicalName < a.LogicalName;
-        }
-
-        IRegisterAddress* CalcNewAddress(uint32_t /*offset*/,
-                                         uint32_t /*stride*/,
-                                         uint32_t /*registerByteWidth*/,
-                                         uint32_t /*addressByteStep*/) const override
-        {
-            return new TObisRegisterAddress(LogicalName);
-        }
+        TDlmsDataAccessException(const std::string& msg): TSerialDeviceTransientErrorException(msg)
+        {}
     };
 
+    bool IsDataAccessError(int err)
+    {
+        return (err >= DLMS_ERROR_CODE_HARDWARE_FAULT) && (err <= DLMS_ERROR_CODE_OTHER_REASON);
+    }
+
     class TObisRegisterAddressFactory: public IRegisterAddressFactory
     {
         TObisRegisterAddress BaseRegisterAddress;
@@ -121,6 +130,16 @@ namespace
             cfg.Authentication = static_cast<DLMS_AUTHENTICATION>(data.get("dlms_auth", cfg.Authentication).asInt());
             cfg.InterfaceType  = static_cast<DLMS_INTERFACE_TYPE>(data.get("dlms_interface", cfg.InterfaceType).asInt());
             WBMQTT::JSON::Get(data, "dlms_disconnect_retry_timeout_ms", cfg.DisconnectRetryTimeout);
+            WBMQTT::JSON::Get(data, "dlms_cache", cfg.CacheStaticAttributes);
+            WBMQTT::JSON::Get(data, "dlms_hdlc_max_info_size", cfg.MaxInfoSize);
+            WBMQTT::JSON::Get(data, "dlms_hdlc_window_size", cfg.WindowSize);
+            if (cfg.MaxInfoSize < MIN_HDLC_INFO_SIZE || cfg.MaxInfoSize > MAX_HDLC_INFO_SIZE) {
+                throw TConfigParserException("dlms_hdlc_max_info_size must be in range [" + std::to_string(MIN_HDLC_INFO_SIZE) +
+                                             ", " + std::to_string(MAX_HDLC_INFO_SIZE) + "]");
+            }
+            if (cfg.WindowSize < 1 || cfg.WindowSize > MAX_HDLC_WINDOW_SIZE) {
+                throw TConfigParserException("dlms_hdlc_window_size must be in range [1, " + std::to_string(MAX_HDLC_WINDOW_SIZE) + "]");
+            }
 
             return std::make_shared<TDlmsDevice>(cfg, port, protocol);
         }
@@ -317,10 +336,16 @@ namespace
         return res;
     }
 
+    TDlmsCache& GetCache()
+    {
+        static TDlmsCache cache(CACHE_FULL_FILE_PATH);
+        return cache;
+    }
+
     const TObisRegisterAddress& ToTObisRegisterAddress(PRegister reg)
     {
         try {
-            return dynamic_cast<const TObisRegisterAddress&>(reg->GetAddress());
+            return dynamic_cast<const TObisRegisterAddress&>(reg->GetConfig()->GetAddress());
         } catch (const std::bad_cast&) {
             throw TSerialDeviceTransientErrorException("Address of " + reg->ToString() + " can't be casted to TObisRegisterAddress");
         }
@@ -329,14 +354,18 @@ namespace
 
 void TDlmsDevice::Register(TSerialDeviceFactory& factory)
 {
-    factory.RegisterProtocol(new TUint32SlaveIdProtocol("dlms", TRegisterTypes({{ 0, "default", "value", Double, true }})), 
+    factory.RegisterProtocol(new TUint32SlaveIdProtocol("dlms", TRegisterTypes({{ DEFAULT_REGISTER_TYPE, "default", "value", Double, true },
+                                                                                 { PROFILE_REGISTER_TYPE, "profile", "value", Double, true }})), 
                              new TDlmsDeviceFactory());
 }
 
 TDlmsDevice::TDlmsDevice(const TDlmsDeviceConfig& config, PPort port, PProtocol protocol)
     : TSerialDevice(config.DeviceConfig, port, protocol),
       TUInt32SlaveId(config.DeviceConfig->SlaveId),
-      DisconnectRetryTimeout(config.DisconnectRetryTimeout)
+      DisconnectRetryTimeout(config.DisconnectRetryTimeout),
+      LogicalDeviceAddress(config.LogicalDeviceAddress),
+      CacheStaticAttributes(config.CacheStaticAttributes),
+      MeterIdRequested(false)
 {
     auto pwd = config.DeviceConfig->Password;
     if (pwd.empty() || pwd.back() != 0) {
@@ -361,6 +390,16 @@ TDlmsDevice::TDlmsDevice(const TDlmsDeviceConfig& config, PPort port, PProtocol
                                                    config.Authentication, 
                                                    (const char*)(&pwd[0]),
                                                    config.InterfaceType);
+
+    // Proposed values are sent in SNRM request only if they differ from defaults,
+    // actual values are taken from meter's UA response
+    if (config.InterfaceType == DLMS_INTERFACE_TYPE_HDLC) {
+        auto& limits = Client->GetLimits();
+        limits.SetMaxInfoRX(config.MaxInfoSize);
+        limits.SetMaxInfoTX(config.MaxInfoSize);
+        limits.SetWindowSizeRX(config.WindowSize);
+        limits.SetWindowSizeTX(config.WindowSize);
+    }
 }
 
 void TDlmsDevice::CheckCycle(std::function<int(std::vector<CGXByteBuffer>&)> requestsGenerator,
@@ -376,6 +415,8 @@ void TDlmsDevice::CheckCycle(std::function<int(std::vector<CGXByteBuffer>&)> req
     for (auto& buf: data) { 
         try { 
             ReadDataBlock(buf.GetData(), buf.GetSize(), reply); 
+        } catch (const TDlmsDataAccessException& e) {
+            throw TDlmsDataAccessException(errorMsg + ". " + e.what());
         } catch (const std::exception& e) { 
             throw TSerialDeviceTransientErrorException(errorMsg + ". " + e.what()); 
         } 
@@ -396,7 +437,7 @@ void TDlmsDevice::ReadAttribute(const std::string& addr, int attribute, CGXDLMSO
                 "Getting " + addr + ":" + std::to_string(attribute) + " failed");
 }
 
-uint64_t TDlmsDevice::ReadRegister(PRegister reg)
+CGXDLMSObject* TDlmsDevice::GetRegisterObject(PRegister reg)
 {
     auto addr = ToTObisRegisterAddress(reg).GetLogicalName();
     auto obj  = Client->GetObjects().FindByLN(DLMS_OBJECT_TYPE_REGISTER, addr);
@@ -407,33 +448,316 @@ uint64_t TDlmsDevice::ReadRegister(PRegister reg)
         }
         Client->GetObjects().push_back(obj);
     }
+    return obj;
+}
 
-    bool forceValueRead = true;
-
-    const auto REGISTER_VALUE_ATTRIBUTE_INDEX = 2;
-    std::vector<int> attributes;
-    obj->GetAttributeIndexToRead(false, attributes);
-    for (auto pos: attributes) {
-        ReadAttribute(addr, pos, *obj);
-        if (pos == REGISTER_VALUE_ATTRIBUTE_INDEX) {
-            forceValueRead = false;
+std::vector<int> TDlmsDevice::GetAttributesToRead(CGXDLMSObject& obj)
+{
+    std::string logicalName;
+    obj.GetLogicalName(logicalName);
+    if (!KnownScalerUnits.count(logicalName) && !MeterId.empty()) {
+        TDlmsScalerUnit scalerUnit;
+        if (GetCache().GetScalerUnit(MeterId, logicalName, scalerUnit)) {
+            CGXDLMSVariant value;
+            value.vt = DLMS_DATA_TYPE_STRUCTURE;
+            value.Arr.push_back(CGXDLMSVariant(static_cast<char>(scalerUnit.Scaler)));
+            value.Arr.push_back(CGXDLMSVariant(static_cast<unsigned char>(scalerUnit.Unit)));
+            if (Client->UpdateValue(obj, REGISTER_SCALER_UNIT_ATTRIBUTE_INDEX, value) == DLMS_ERROR_CODE_OK) {
+                KnownScalerUnits.insert(logicalName);
+            }
         }
     }
 
+    // Scaler and unit are static, so only value is read
+    if (KnownScalerUnits.count(logicalName)) {
+        return {REGISTER_VALUE_ATTRIBUTE_INDEX};
+    }
+
+    std::vector<int> attributes;
+    obj.GetAttributeIndexToRead(false, attributes);
+
     // Some devices doesn't set read access, let's force read value 
-    if (forceValueRead) {
-        ReadAttribute(addr, REGISTER_VALUE_ATTRIBUTE_INDEX, *obj);
+    if (std::find(attributes.begin(), attributes.end(), REGISTER_VALUE_ATTRIBUTE_INDEX) == attributes.end()) {
+        attributes.push_back(REGISTER_VALUE_ATTRIBUTE_INDEX);
     }
+    return attributes;
+}
 
-    auto r = static_cast<CGXDLMSRegister*>(obj);
+uint64_t TDlmsDevice::GetRegisterValue(PRegister reg, CGXDLMSObject& obj)
+{
+    auto r = static_cast<CGXDLMSRegister*>(&obj);
 
     if (!r->GetValue().IsNumber()) {
-        throw TSerialDevicePermanentRegisterException(addr + " value is not a number");
+        throw TSerialDevicePermanentRegisterException(ToTObisRegisterAddress(reg).GetLogicalName() + " value is not a number");
     }
 
     return CopyDoubleToUint64(r->GetValue().ToDouble());
 }
 
+void TDlmsDevice::RememberScalerUnit(CGXDLMSObject& obj)
+{
+    std::string logicalName;
+    obj.GetLogicalName(logicalName);
+    if (!KnownScalerUnits.insert(logicalName).second || MeterId.empty()) {
+        return;
+    }
+    auto r = static_cast<CGXDLMSRegister*>(&obj);
+    TDlmsScalerUnit scalerUnit;
+    scalerUnit.Scaler = static_cast<int8_t>(std::lround(std::log10(r->GetScaler())));
+    scalerUnit.Unit   = static_cast<uint8_t>(r->GetUnit());
+    GetCache().SetScalerUnit(MeterId, logicalName, scalerUnit);
+}
+
+uint64_t TDlmsDevice::ReadRegister(PRegister reg)
+{
+    if (reg->GetConfig()->Type == PROFILE_REGISTER_TYPE) {
+        return ReadProfileEntry(reg);
+    }
+    auto addr = ToTObisRegisterAddress(reg).GetLogicalName();
+    auto obj  = GetRegisterObject(reg);
+    for (auto pos: GetAttributesToRead(*obj)) {
+        ReadAttribute(addr, pos, *obj);
+        if (pos == REGISTER_SCALER_UNIT_ATTRIBUTE_INDEX) {
+            RememberScalerUnit(*obj);
+        }
+    }
+    return GetRegisterValue(reg, *obj);
+}
+
+uint64_t TDlmsDevice::ReadProfileEntry(PRegister reg)
+{
+    const auto& address = ToTObisRegisterAddress(reg);
+    auto profileId = GetProfileId(reg);
+    auto res = Profiles.emplace(profileId, TDlmsProfileColumn());
+    auto& profile = res.first->second;
+    if (res.second) {
+        time_t mark;
+        if (GetCache().GetProfileTime(profileId, mark)) {
+            profile.SetMark(mark);
+        }
+    }
+    if (!profile.HasEntries()) {
+        ReadProfileEntries(reg, profile);
+    }
+
+    double value;
+    auto hasValue = profile.Publish(value);
+    time_t mark;
+    if (profile.GetMark(mark)) {
+        GetCache().SetProfileTime(profileId, mark);
+    }
+    if (!hasValue) {
+        throw TSerialDeviceTransientErrorException("no entries in profile " + address.ToString());
+    }
+    return CopyDoubleToUint64(value);
+}
+
+std::string TDlmsDevice::GetProfileId(PRegister reg) const
+{
+    return (MeterId.empty() ? DeviceConfig()->Id : MeterId) + ":" + ToTObisRegisterAddress(reg).ToString();
+}
+
+void TDlmsDevice::ReadProfileEntries(PRegister reg, TDlmsProfileColumn& column)
+{
+    const auto& address = ToTObisRegisterAddress(reg);
+    auto ln = address.GetLogicalName();
+    auto obj = Client->GetObjects().FindByLN(DLMS_OBJECT_TYPE_PROFILE_GENERIC, ln);
+    if (!obj) {
+        obj = CGXDLMSObjectFactory::CreateObject(DLMS_OBJECT_TYPE_PROFILE_GENERIC, ln);
+        if (!obj) {
+            throw TSerialDeviceTransientErrorException("Can't create profile object");
+        }
+        Client->GetObjects().push_back(obj);
+    }
+    auto profile = static_cast<CGXDLMSProfileGeneric*>(obj);
+
+    // Capture objects and period are static, they are read once
+    if (!KnownProfiles.count(ln)) {
+        ReadAttribute(ln, PROFILE_CAPTURE_OBJECTS_ATTRIBUTE_INDEX, *profile);
+        ReadAttribute(ln, PROFILE_CAPTURE_PERIOD_ATTRIBUTE_INDEX, *profile);
+        KnownProfiles.insert(ln);
+    }
+    if (address.GetColumn() == 0 || address.GetColumn() > profile->GetCaptureObjects().size()) {
+        throw TSerialDevicePermanentRegisterException("profile " + ln + " doesn't have column " + std::to_string(address.GetColumn()));
+    }
+
+    time_t period = profile->GetCapturePeriod();
+    if (period == 0) {
+        period = DEFAULT_PROFILE_CAPTURE_PERIOD.count();
+    }
+
+    TDlmsProfileColumn::TRange range;
+    auto now = time(nullptr);
+    if (!column.GetRange(now, period, MAX_PROFILE_ENTRIES_PER_READ, range)) {
+        return;
+    }
+    struct tm startTm, endTm;
+    localtime_r(&range.Start, &startTm);
+    localtime_r(&range.End, &endTm);
+    CGXDateTime start(startTm);
+    CGXDateTime end(endTm);
+    CheckCycle([&](auto& data)  { return Client->ReadRowsByRange(profile, start, end, data); },
+               [&](auto& reply) { return Client->UpdateValue(*profile, PROFILE_BUFFER_ATTRIBUTE_INDEX, reply.GetValue()); },
+               "Reading profile " + ln + " failed");
+
+    for (auto& row: profile->GetBuffer()) {
+        if (row.size() < address.GetColumn() || row.empty()) {
+            continue;
+        }
+        CGXDLMSVariant timeValue;
+        if (row[0].vt == DLMS_DATA_TYPE_DATETIME) {
+            timeValue = row[0];
+        } else if (CGXDLMSClient::ChangeType(row[0], DLMS_DATA_TYPE_DATETIME, timeValue) != DLMS_ERROR_CODE_OK) {
+            continue;
+        }
+        auto tm = timeValue.dateTime.GetValue();
+        auto entryTime = mktime(&tm);
+
+        // Clock column is published as unix time, so a channel shows time of entries published by other columns
+        if (address.GetColumn() == 1) {
+            column.AddEntry(entryTime, entryTime);
+            continue;
+        }
+        auto& value = row[address.GetColumn() - 1];
+        if (value.IsNumber()) {
+            column.AddEntry(entryTime, value.ToDouble());
+        }
+    }
+    profile->GetBuffer().clear();
+
+    column.EndRange(now);
+}
+
+bool TDlmsDevice::ReadList(std::vector<std::pair<CGXDLMSObject*, unsigned char>>& list)
+{
+    // Client splits the list into several requests fitting negotiated PDU size
+    std::vector<CGXByteBuffer> data;
+    auto res = Client->ReadList(list, data);
+    if (res != DLMS_ERROR_CODE_OK) {
+        throw TSerialDeviceTransientErrorException("Reading with list failed. Can't generate request: " + GetErrorMessage(res));
+    }
+    std::vector<CGXDLMSVariant> values;
+    for (auto& buf: data) {
+        CGXReplyData reply;
+        try {
+            ReadDataBlock(buf.GetData(), buf.GetSize(), reply);
+        } catch (const TDlmsDataAccessException& e) {
+            // Device has answered, but some attributes can't be read
+            LOG(Debug) << "Reading with list failed: " << e.what();
+            return false;
+        } catch (const std::exception& e) {
+            // Port errors and broken frames, the device may have no problems with the list
+            throw TSerialDeviceTransientErrorException(std::string("Reading with list failed. ") + e.what());
+        }
+        if (IsDataAccessError(reply.GetError()) || reply.GetValue().vt != DLMS_DATA_TYPE_ARRAY) {
+            return false;
+        }
+        if (reply.GetError() != 0) {
+            throw TSerialDeviceTransientErrorException("Reading with list failed: " + GetErrorMessage(reply.GetError()));
+        }
+        values.insert(values.end(), reply.GetValue().Arr.begin(), reply.GetValue().Arr.end());
+    }
+    if (values.size() != list.size()) {
+        return false;
+    }
+    return Client->UpdateValues(list, values) == DLMS_ERROR_CODE_OK;
+}
+
+std::vector<PRegisterRange> TDlmsDevice::ReadRegisterRange(PRegisterRange range)
+{
+    PSimpleRegisterRange simpleRange = std::dynamic_pointer_cast<TSimpleRegisterRange>(range);
+    if (!simpleRange) {
+        throw std::runtime_error("simple range expected");
+    }
+
+    if (!(Client->GetNegotiatedConformance() & DLMS_CONFORMANCE_MULTIPLE_REFERENCES) ||
+        simpleRange->RegisterList().front()->GetConfig()->Type == PROFILE_REGISTER_TYPE)
+    {
+        return TSerialDevice::ReadRegisterRange(range);
+    }
+
+    std::vector<std::pair<PRegister, CGXDLMSObject*>> regs;
+    std::vector<std::pair<CGXDLMSObject*, unsigned char>> list;
+    for (auto reg: simpleRange->RegisterList()) {
+        if (!reg->IsAvailable()) {
+            continue;
+        }
+        auto obj = GetRegisterObject(reg);
+        regs.emplace_back(reg, obj);
+        for (auto pos: GetAttributesToRead(*obj)) {
+            list.emplace_back(obj, pos);
+        }
+    }
+    if (regs.size() < 2) {
+        return TSerialDevice::ReadRegisterRange(range);
+    }
+
+    try {
+        Port()->SleepSinceLastInteraction(DeviceConfig()->RequestDelay);
+        if (!ReadList(list)) {
+            // Per-attribute errors are reported only by separate requests
+            LOG(Debug) << "Some registers can't be read with list, read them one by one";
+            return TSerialDevice::ReadRegisterRange(range);
+        }
+    } catch (const TSerialDeviceTransientErrorException& e) {
+        simpleRange->SetError(ST_UNKNOWN_ERROR);
+        auto& logger = GetIsDisconnected() ? Debug : Warn;
+        LOG(logger) << "TDlmsDevice::ReadRegisterRange(): " << e.what();
+        return {range};
+    }
+
+    for (const auto& item: list) {
+        if (item.second == REGISTER_SCALER_UNIT_ATTRIBUTE_INDEX) {
+            RememberScalerUnit(*item.first);
+        }
+    }
+
+    for (auto& reg: regs) {
+        try {
+            reg.first->SetValue(GetRegisterValue(reg.first, *reg.second));
+        } catch (const TSerialDevicePermanentRegisterException& e) {
+            reg.first->SetAvailable(false);
+            reg.first->SetError(ST_DEVICE_ERROR);
+            LOG(Warn) << "TDlmsDevice::ReadRegisterRange(): " << e.what() 
+                      << ". Register " << reg.first->ToString() << " is now marked as unsupported";
+        }
+    }
+    return {range};
+}
+
+std::vector<PRegisterRange> TDlmsDevice::SplitRegisterList(const std::vector<PRegister>& reg_list, bool /*enableHoles*/) const
+{
+    // Registers with the same poll interval are read by GET-Request-With-List.
+    // Ranges are sub-spans of one span of registers ordered by poll interval
+    std::vector<PRegisterRange> r;
+    std::vector<PRegister> listRegs;
+    for (auto reg: reg_list) {
+        if (reg->GetConfig()->Type == PROFILE_REGISTER_TYPE) {
+            r.push_back(std::make_shared<TSimpleRegisterRange>(reg));
+        } else {
+            listRegs.push_back(reg);
+        }
+    }
+    if (listRegs.empty()) {
+        return r;
+    }
+    std::stable_sort(listRegs.begin(), listRegs.end(), [](const PRegister& a, const PRegister& b) {
+        return a->GetConfig()->PollInterval < b->GetConfig()->PollInterval;
+    });
+    TRegisterSpan regs(listRegs);
+    size_t start = 0;
+    for (size_t i = 1; i <= regs.size(); ++i) {
+        if (i == regs.size() ||
+            i - start == MAX_REGISTERS_IN_LIST ||
+            regs[i]->GetConfig()->PollInterval != regs[start]->GetConfig()->PollInterval)
+        {
+            r.push_back(std::make_shared<TSimpleRegisterRange>(regs.Sub(start, i - start)));
+            start = i;
+        }
+    }
+    return r;
+}
+
 void TDlmsDevice::WriteRegister(PRegister reg, uint64_t value)
 {
     throw TSerialDeviceException("DLMS protocol: writing to registers is not supported");
@@ -452,6 +776,41 @@ void TDlmsDevice::Prepare()
         Disconnect();
     }
     InitializeConnection();
+    if (CacheStaticAttributes && !MeterIdRequested) {
+        ReadMeterId();
+    }
+}
+
+void TDlmsDevice::ReadMeterId()
+{
+    std::string ln(SERIAL_NUMBER_LOGICAL_NAME);
+    auto obj = Client->GetObjects().FindByLN(DLMS_OBJECT_TYPE_DATA, ln);
+    if (!obj) {
+        obj = CGXDLMSObjectFactory::CreateObject(DLMS_OBJECT_TYPE_DATA, ln);
+        if (!obj) {
+            MeterIdRequested = true;
+            return;
+        }
+        Client->GetObjects().push_back(obj);
+    }
+    try {
+        ReadAttribute(ln, DATA_VALUE_ATTRIBUTE_INDEX, *obj);
+    } catch (const TDlmsDataAccessException& e) {
+        // The meter doesn't provide serial number, don't ask it again
+        MeterIdRequested = true;
+        LOG(Debug) << "Can't read serial number, static attributes will not be cached: " << e.what();
+        return;
+    } catch (const std::exception& e) {
+        // No answer or broken one, try again after reconnection
+        LOG(Debug) << "Can't read serial number: " << e.what();
+        return;
+    }
+    MeterIdRequested = true;
+    auto serialNumber = static_cast<CGXDLMSData*>(obj)->GetValue().ToString();
+    if (!serialNumber.empty()) {
+        MeterId = std::to_string(LogicalDeviceAddress) + ":" + serialNumber;
+        LOG(Debug) << "Meter id: " << MeterId;
+    }
 }
 
 void TDlmsDevice::Disconnect()
@@ -477,6 +836,12 @@ void TDlmsDevice::EndSession()
     Disconnect();
 }
 
+void TDlmsDevice::EndPollCycle()
+{
+    GetCache().Save();
+    TSerialDevice::EndPollCycle();
+}
+
 void TDlmsDevice::InitializeConnection()
 {
     LOG(Debug) << "Initialize connection";
@@ -508,6 +873,8 @@ void TDlmsDevice::InitializeConnection()
 
 void TDlmsDevice::SendData(const uint8_t* data, size_t size)
 {
+    // Frames left from previous exchange are not answers to the request
+    RxBuffer.Clear();
     Port()->SleepSinceLastInteraction(DeviceConfig()->FrameTimeout + DeviceConfig()->RequestDelay);
     Port()->WriteBytes(data, size);
 }
@@ -524,6 +891,12 @@ void TDlmsDevice::ReadDataBlock(const uint8_t* data, size_t size, CGXReplyData&
     }
     ReadDLMSPacket(data, size, reply);
     while (reply.IsMoreData()) {
+        // If negotiated window size is more than 1, meter sends several frames in a row
+        // and only the last one has poll/final bit. Next frames are read without waiting for acknowledge
+        if ((reply.GetMoreData() & DLMS_DATA_REQUEST_TYPES_FRAME) && !(reply.GetFrameId() & HDLC_POLL_FINAL_BIT)) {
+            ReadDLMSReply(reply);
+            continue;
+        }
         int ret;
         CGXByteBuffer bb;
         if ((ret = Client->ReceiverReady(reply.GetMoreData(), bb)) != 0) {
@@ -554,9 +927,10 @@ void TDlmsDevice::Read(unsigned char eop, CGXByteBuffer& reply)
         return false;
     };
 
-    uint8_t buf[MAX_PACKET_SIZE];
-    auto bytesRead = Port()->ReadFrame(buf, sizeof(buf), DeviceConfig()->ResponseTimeout, DeviceConfig()->FrameTimeout, frameCompleteFn);
-    reply.Set(buf, bytesRead);
+    // Negotiated information field can be larger than default one
+    std::vector<uint8_t> buf(std::max<size_t>(MAX_PACKET_SIZE, Client->GetLimits().GetMaxInfoRX() + HDLC_FRAME_OVERHEAD));
+    auto bytesRead = Port()->ReadFrame(buf.data(), buf.size(), DeviceConfig()->ResponseTimeout, DeviceConfig()->FrameTimeout, frameCompleteFn);
+    reply.Set(buf.data(), bytesRead);
 }
 
 void TDlmsDevice::ReadDLMSPacket(const uint8_t* data, size_t size, CGXReplyData& reply)
@@ -565,12 +939,29 @@ void TDlmsDevice::ReadDLMSPacket(const uint8_t* data, size_t size, CGXReplyData&
         return;
     }
     SendData(data, size);
+    ReadDLMSReply(reply);
+}
+
+void TDlmsDevice::ReadDLMSReply(CGXReplyData& reply)
+{
+    // The frame can be already received with the previous one
     int ret = DLMS_ERROR_CODE_FALSE;
-    CGXByteBuffer bb;
+    if (RxBuffer.Available() != 0) {
+        ret = Client->GetData(RxBuffer, reply);
+    }
     // Loop until whole DLMS packet is received.
     while (ret == DLMS_ERROR_CODE_FALSE) {
-        ReadData(bb);
-        ret = Client->GetData(bb, reply);
+        ReadData(RxBuffer);
+        ret = Client->GetData(RxBuffer, reply);
+    }
+    if (ret != DLMS_ERROR_CODE_OK) {
+        // Position in a broken frame is unknown, so the rest of received data is useless
+        RxBuffer.Clear();
+    } else {
+        RxBuffer.Trim();
+    }
+    if (IsDataAccessError(ret)) {
+        throw TDlmsDataAccessException("Read DLMS packet failed: " + GetErrorMessage(ret));
     }
     if (ret != DLMS_ERROR_CODE_OK) {
         throw std::runtime_error("Read DLMS packet failed: " + GetErrorMessage(ret));
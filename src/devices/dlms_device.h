@@ -3,9 +3,13 @@
 #include "serial_device.h"
 #include "serial_config.h"
 #include "device_template_generator.h"
+#include "dlms_profile.h"
 
 #include "GXDLMSSecureClient.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
 const int PUBLIC_CLIENT_ADDRESS = 16;
 
 struct TDlmsDeviceConfig
@@ -18,12 +22,39 @@ struct TDlmsDeviceConfig
     DLMS_AUTHENTICATION       Authentication            = DLMS_AUTHENTICATION_NONE;
     DLMS_INTERFACE_TYPE       InterfaceType             = DLMS_INTERFACE_TYPE_HDLC;
     std::chrono::milliseconds DisconnectRetryTimeout    = std::chrono::milliseconds::zero();
+
+    //! Keep scaler and unit of registers in persistent cache
+    bool                      CacheStaticAttributes     = false;
+
+    //! Proposed HDLC parameters, meter can accept smaller values
+    int                       MaxInfoSize               = 128;
+    int                       WindowSize                = 1;
 };
 
 class TDlmsDevice: public TSerialDevice, public TUInt32SlaveId
 {
     std::unique_ptr<CGXDLMSSecureClient> Client;
+
+    //! Received, but not yet parsed data. One read can return several frames if HDLC window size is more than 1
+    CGXByteBuffer                        RxBuffer;
     std::chrono::milliseconds            DisconnectRetryTimeout;
+    int                                  LogicalDeviceAddress;
+    bool                                 CacheStaticAttributes;
+
+    //! Logical device address and serial number, empty if serial number is unknown
+    std::string                          MeterId;
+
+    //! The meter has answered serial number request, with the number or with an error
+    bool                                 MeterIdRequested;
+
+    //! Logical names of registers with already read or cached scaler and unit
+    std::unordered_set<std::string>      KnownScalerUnits;
+
+    //! Logical names of profiles with already read capture objects and period
+    std::unordered_set<std::string>      KnownProfiles;
+
+    //! Profile registers state by profile id, so a replaced meter gets a new state
+    std::unordered_map<std::string, TDlmsProfileColumn> Profiles;
 
     void InitializeConnection();
     void SendData(const uint8_t* data, size_t size);
@@ -32,7 +63,21 @@ class TDlmsDevice: public TSerialDevice, public TUInt32SlaveId
     void ReadData(CGXByteBuffer& reply);
     void ReadDataBlock(const uint8_t* data, size_t size, CGXReplyData& reply);
     void ReadDLMSPacket(const uint8_t* data, size_t size, CGXReplyData& reply);
+    void ReadDLMSReply(CGXReplyData& reply);
     void ReadAttribute(const std::string& addr, int attribute, CGXDLMSObject& obj);
+
+    //! Returns false if the device has answered, but some attributes can't be read
+    bool ReadList(std::vector<std::pair<CGXDLMSObject*, unsigned char>>& list);
+    CGXDLMSObject* GetRegisterObject(PRegister reg);
+    std::vector<int> GetAttributesToRead(CGXDLMSObject& obj);
+    uint64_t GetRegisterValue(PRegister reg, CGXDLMSObject& obj);
+    void RememberScalerUnit(CGXDLMSObject& obj);
+    void ReadMeterId();
+    uint64_t ReadProfileEntry(PRegister reg);
+    void ReadProfileEntries(PRegister reg, TDlmsProfileColumn& column);
+
+    //! Key of profile register in persistent cache. Meter id is used if it is known, device id otherwise
+    std::string GetProfileId(PRegister reg) const;
     void GetAssociationView();
     void Disconnect();
 
@@ -44,10 +89,15 @@ public:
     TDlmsDevice(const TDlmsDeviceConfig& config, PPort port, PProtocol protocol);
 
     uint64_t ReadRegister(PRegister reg) override;
+    std::vector<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister>& reg_list, bool enableHoles = true) const override;
     void WriteRegister(PRegister reg, uint64_t value) override;
     void Prepare() override;
     void EndSession() override;
 
+    //! Writes scaler, unit and profile read times collected during the cycle to persistent cache
+    void EndPollCycle() override;
+
     static void Register(TSerialDeviceFactory& factory);
 
     const CGXDLMSObjectCollection& ReadAllObjects(bool readAttributes);
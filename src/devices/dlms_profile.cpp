@@ -0,0 +1,70 @@
+#include "dlms_profile.h"
+
+#include <algorithm>
+
+void TDlmsProfileColumn::SetMark(time_t mark)
+{
+    Mark = mark;
+    HasMark = true;
+}
+
+bool TDlmsProfileColumn::GetMark(time_t& mark) const
+{
+    mark = Mark;
+    return HasMark;
+}
+
+bool TDlmsProfileColumn::GetRange(time_t now, time_t period, size_t maxEntries, TRange& range)
+{
+    time_t lastTime;
+    if (!HasMark) {
+        lastTime = now - 2 * period;
+    } else if (!HasValue) {
+        lastTime = Mark - period;
+    } else {
+        lastTime = Mark;
+    }
+
+    // Next entry is captured a period after the last one
+    if (now < lastTime + period) {
+        return false;
+    }
+    Range.Start = lastTime + 1;
+    Range.End = std::min<time_t>(now, lastTime + maxEntries * period);
+    range = Range;
+    return true;
+}
+
+void TDlmsProfileColumn::AddEntry(time_t time, double value)
+{
+    // Some meters include the entry at start of range, it is already published
+    if (time >= Range.Start) {
+        Entries.push_back({time, value});
+    }
+}
+
+void TDlmsProfileColumn::EndRange(time_t now)
+{
+    // Nothing is captured in the range. Move to the next range
+    if (Entries.empty() && Range.End < now) {
+        SetMark(Range.End);
+    }
+}
+
+bool TDlmsProfileColumn::HasEntries() const
+{
+    return !Entries.empty();
+}
+
+bool TDlmsProfileColumn::Publish(double& value)
+{
+    if (!Entries.empty()) {
+        auto entry = Entries.front();
+        Entries.pop_front();
+        LastValue = entry.Value;
+        HasValue = true;
+        SetMark(entry.Time);
+    }
+    value = LastValue;
+    return HasValue;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ctime>
+#include <deque>
+
+/**
+ * @brief Incremental reading of a profile generic column.
+ *        Entries are published one by one from the oldest, so a gap after a long disconnection is filled gradually.
+ *        Time of the last published entry is a high-water mark, only newer entries are requested from the meter.
+ *        If a requested range is empty, e.g. the meter was off, the mark is moved to the end of the range.
+ */
+class TDlmsProfileColumn
+{
+public:
+    struct TRange
+    {
+        time_t Start;
+        time_t End;
+    };
+
+    //! Sets the mark loaded from persistent cache
+    void SetMark(time_t mark);
+
+    //! Returns false if the mark is not set yet
+    bool GetMark(time_t& mark) const;
+
+    /**
+     * @brief Get range of entries to request.
+     *        If the profile hasn't been read yet, the range starts before the last entry.
+     *        After restart the last published entry is read again to have a value to publish.
+     *
+     * @param now current time
+     * @param period capture period of the profile
+     * @param maxEntries maximum number of entries in the range
+     * @return false if no new entries can be captured since the last read, the meter should not be asked
+     */
+    bool GetRange(time_t now, time_t period, size_t maxEntries, TRange& range);
+
+    //! Adds an entry of the range got by GetRange. Entries not newer than the mark are ignored
+    void AddEntry(time_t time, double value);
+
+    //! Call after all entries of the range are added
+    void EndRange(time_t now);
+
+    //! There are read, but not yet published entries
+    bool HasEntries() const;
+
+    /**
+     * @brief Publish the oldest read entry and move the mark to it.
+     *        If there are no new entries, the last published value is returned again.
+     *
+     * @return false if nothing has been published yet
+     */
+    bool Publish(double& value);
+
+private:
+    struct TEntry
+    {
+        time_t Time;
+        double Value;
+    };
+
+    std::deque<TEntry> Entries;
+    time_t             Mark      = 0;
+    bool               HasMark   = false;
+    double             LastValue = 0;
+    bool               HasValue  = false;
+    TRange             Range     = {0, 0};
+};
@@ -1,7 +1,85 @@
 #include "em_device.h"
 
+#include <map>
+#include <mutex>
+#include <tuple>
+
+//! Protocol, slave id, access level and password of a meter's communication channel
+typedef std::tuple<std::string, uint32_t, int, std::vector<uint8_t>> TEMSessionKey;
+
+/**
+ * @brief Open communication channels of EM meters on a port.
+ *        Keeps time of last exchange with every meter to detect channels closed by meter's timeout.
+ *        A meter has only one channel, devices with different access levels or passwords can't share it.
+ *        Used only from the port's thread.
+ */
+class TEMSessions
+{
+public:
+    bool IsOpen(const TEMSessionKey& key, TTimePoint now, std::chrono::milliseconds timeout) const
+    {
+        auto it = LastExchange.find(key);
+        if (it == LastExchange.end()) {
+            return false;
+        }
+        return timeout == std::chrono::milliseconds::zero() || now - it->second < timeout;
+    }
+
+    //! Channel is opened, a channel of the meter with other access level or password is closed by the meter
+    void Open(const TEMSessionKey& key, TTimePoint now)
+    {
+        Close(key);
+        LastExchange[key] = now;
+    }
+
+    void Update(const TEMSessionKey& key, TTimePoint now)
+    {
+        LastExchange[key] = now;
+    }
+
+    //! Closes all channels of the meter
+    void Close(const TEMSessionKey& key)
+    {
+        for (auto it = LastExchange.begin(); it != LastExchange.end();) {
+            if (std::get<0>(it->first) == std::get<0>(key) && std::get<1>(it->first) == std::get<1>(key)) {
+                it = LastExchange.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+private:
+    std::map<TEMSessionKey, TTimePoint> LastExchange;
+};
+
+namespace
+{
+    std::shared_ptr<TEMSessions> GetSessions(PPort port)
+    {
+        // Sessions are kept while there are devices using them.
+        // Port is checked too, as address of deleted port can be reused by a new one
+        static std::mutex mutex;
+        static std::map<TPort*, std::pair<std::weak_ptr<TPort>, std::weak_ptr<TEMSessions>>> sessions;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        auto& item = sessions[port.get()];
+        auto res = item.second.lock();
+        if (!res || item.first.lock() != port) {
+            res = std::make_shared<TEMSessions>();
+            item = {port, res};
+        }
+        return res;
+    }
+
+    TEMSessionKey GetSessionKey(const std::string& protocol, uint32_t slaveId, const TDeviceConfig& config)
+    {
+        return TEMSessionKey(protocol, slaveId, config.AccessLevel, config.Password);
+    }
+}
+
 TEMDevice::TEMDevice(PDeviceConfig config, PPort port, PProtocol protocol)
-    : TSerialDevice(config, port, protocol), TUInt32SlaveId(config->SlaveId, true)
+    : TSerialDevice(config, port, protocol), TUInt32SlaveId(config->SlaveId, true), Sessions(GetSessions(port))
 {
     if (HasBroadcastSlaveId) {
         SlaveId = 0;
@@ -87,6 +165,7 @@ void TEMDevice::Talk( uint8_t cmd, uint8_t* payload, int payload_len,
             EnsureSlaveConnected( true);
             WriteCommand(cmd, payload, payload_len);
         }
+        Sessions->Update(GetSessionKey(Protocol()->GetName(), SlaveId, *DeviceConfig()), Port()->CurrentTime());
     } catch ( const TSerialDeviceTransientErrorException& e) {
         Port()->SkipNoise();
         throw;
@@ -95,13 +174,14 @@ void TEMDevice::Talk( uint8_t cmd, uint8_t* payload, int payload_len,
 
 void TEMDevice::EnsureSlaveConnected(bool force)
 {
-    if (!force && ConnectedSlaves.find(SlaveId) != ConnectedSlaves.end())
+    auto key = GetSessionKey(Protocol()->GetName(), SlaveId, *DeviceConfig());
+    if (!force && Sessions->IsOpen(key, Port()->CurrentTime(), SessionTimeout))
         return;
 
-    ConnectedSlaves.erase(SlaveId);
+    Sessions->Close(key);
     Port()->SkipNoise();
     if (!ConnectionSetup())
         throw TSerialDeviceTransientErrorException("failed to establish meter connection");
 
-    ConnectedSlaves.insert(SlaveId);
+    Sessions->Open(key, Port()->CurrentTime());
 }
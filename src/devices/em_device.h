@@ -3,7 +3,6 @@
 #include <string>
 #include <memory>
 #include <exception>
-#include <unordered_set>
 #include <functional>
 #include <cstdint>
 #include <cstring>
@@ -11,6 +10,8 @@
 #include "serial_device.h"
 #include "crc16.h"
 
+class TEMSessions;
+
 // Common device base for electricity meters
 class TEMDevice: public TSerialDevice, public TUInt32SlaveId
 {
@@ -42,8 +43,12 @@ protected:
 
     uint8_t SlaveIdWidth = 1;
 
+    //! Meter closes communication channel if there were no requests during the timeout, 0 - channel is never closed
+    std::chrono::milliseconds SessionTimeout = std::chrono::milliseconds::zero();
+
 private:
     void EnsureSlaveConnected(bool force = false);
 
-    std::unordered_set<uint8_t> ConnectedSlaves;
+    //! Open channels are tracked per port, so devices with the same protocol, slave id, access level and password share them
+    std::shared_ptr<TEMSessions> Sessions;
 };
@@ -1,6 +1,9 @@
 #include "energomera_iec_device.h"
 
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <tuple>
 
 #include "iec_common.h"
 #include "log.h"
@@ -10,62 +13,107 @@
 namespace
 {
     const char* LOG_PREFIX = "[Energomera] ";
+
+    const int CodeUnsupportedParameter = 12;
+    const int CodeUnsupportedParameterValue = 17;
+
+    const size_t RESPONSE_BUF_LEN = 1000;
+    const size_t MIN_RESPONSE_SIZE = 32;
+    const size_t DEFAULT_MAX_RESPONSE_SIZE = 256;
+
+    // Maximum length of request
+    const size_t MAX_REQUEST_LEN = 126;
+    // "/?" + "!<SOH>" + "R1<STX>GROUP(" + ")<ETX>" + <BCC>
+    const size_t REQUEST_HEADER_LEN = 16;
+    // <STX> + <ETX> + <BCC>
+    const size_t RESPONSE_HEADER_LEN = 3;
+    const size_t PARAM_ID_LEN = 4;
+    // Estimated length of a value with brackets
+    const size_t MAX_VALUE_LEN = 18;
+
+    class TEnergomeraDeviceFactory: public IDeviceFactory
+    {
+    public:
+        TEnergomeraDeviceFactory()
+            : IDeviceFactory(std::make_unique<TUint32RegisterAddressFactory>(),
+                             "#/definitions/energomera_iec_device",
+                             "#/definitions/common_channel")
+        {}
+
+        PSerialDevice CreateDevice(const Json::Value& data,
+                                   PDeviceConfig      deviceConfig,
+                                   PPort              port,
+                                   PProtocol          protocol) const override
+        {
+            auto dev = std::make_shared<TEnergomeraIecWithFastReadDevice>(deviceConfig, port, protocol);
+            int maxResponseSize = DEFAULT_MAX_RESPONSE_SIZE;
+            WBMQTT::JSON::Get(data, "energomera_max_response_size", maxResponseSize);
+            if (maxResponseSize < static_cast<int>(MIN_RESPONSE_SIZE) || maxResponseSize > static_cast<int>(RESPONSE_BUF_LEN)) {
+                throw TConfigParserException("energomera_max_response_size must be in range [" + std::to_string(MIN_RESPONSE_SIZE) +
+                                             ", " + std::to_string(RESPONSE_BUF_LEN) + "]");
+            }
+            dev->SetMaxResponseSize(maxResponseSize);
+            dev->InitSetupItems();
+            return dev;
+        }
+    };
 }
 
 void TEnergomeraIecWithFastReadDevice::Register(TSerialDeviceFactory& factory)
 {
     factory.RegisterProtocol(new TIEC61107Protocol("energomera_iec", {{ 0, "group_single", "value", Double, true }}),
-                             new TBasicDeviceFactory<TEnergomeraIecWithFastReadDevice>("#/definitions/simple_device_with_broadcast", 
-                                                                                       "#/definitions/common_channel"));
+                             new TEnergomeraDeviceFactory());
 }
 
 namespace
 {
-    const int CodeUnsupportedParameter = 12;
-    const int CodeUnsupportedParameterValue = 17;
-
-    const size_t RESPONSE_BUF_LEN = 1000;
-
     uint16_t GetParamId(const PRegister & reg)
     {
-        return ((GetUint32RegisterAddress(reg->GetAddress()) & 0xFFFF00) >> 8) & 0xFFFF;
+        return ((GetUint32RegisterAddress(reg->GetConfig()->GetAddress()) & 0xFFFF00) >> 8) & 0xFFFF;
     }
 
     uint8_t GetValueNum(const PRegister & reg)
     {
-        return GetUint32RegisterAddress(reg->GetAddress()) & 0xFF;
+        return GetUint32RegisterAddress(reg->GetConfig()->GetAddress()) & 0xFF;
     }
 
     class TEnergomeraRegisterRange: public TSimpleRegisterRange
     {
     public:
-        TEnergomeraRegisterRange(const std::list<PRegister>& regs) : TSimpleRegisterRange(regs) {
-            std::list<PRegister> sorted_reg_list = regs;
-            sorted_reg_list.sort(
-                [](const PRegister& a, const  PRegister& b) -> bool {
-                    if (GetParamId(a) < GetParamId(b)) return true;
-                    if (GetParamId(a) > GetParamId(b)) return false;
+        TEnergomeraRegisterRange(const TRegisterSpan& regs) : TSimpleRegisterRange(regs) {}
+    };
 
-                    if (GetValueNum(a) < GetValueNum(b)) return true;
-                    if (GetValueNum(a) > GetValueNum(b)) return false;
+    // x[Param] -> Regs (sorted by bit number)
+    typedef std::map<uint16_t, std::vector<PRegister>> TRegsByParam;
 
-                    return false;
-                }
-            );
-
-            for (auto reg: sorted_reg_list) {
-                auto param_id = GetParamId(reg);
-                auto value_num = GetValueNum(reg);
-                ParamMasks[param_id] |= (1 << (value_num - 1));
-                RegsByParam[param_id].push_back(reg);
-            };
-        };
-    public:
-        std::map<uint16_t, uint16_t> ParamMasks;
+    TRegsByParam GroupByParam(const TRegisterSpan& regs, bool onlyAvailable)
+    {
+        std::vector<PRegister> sorted_reg_list(regs.begin(), regs.end());
+        std::stable_sort(sorted_reg_list.begin(), sorted_reg_list.end(),
+            [](const PRegister& a, const  PRegister& b) -> bool {
+                return GetValueNum(a) < GetValueNum(b);
+            }
+        );
 
-        // x[Param] -> Regs (sorted by bit number)
-        std::map<uint16_t, std::list<PRegister> > RegsByParam;
-    };
+        TRegsByParam res;
+        for (auto reg: sorted_reg_list) {
+            if (!onlyAvailable || reg->IsAvailable()) {
+                res[GetParamId(reg)].push_back(reg);
+            }
+        }
+        return res;
+    }
+
+    template<class TRegs> std::string GetParamQuery(uint16_t param_id, const TRegs& regs)
+    {
+        uint16_t mask = 0;
+        for (const auto& reg: regs) {
+            mask |= (1 << (GetValueNum(reg) - 1));
+        }
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%04hX(%hX)", param_id, mask);
+        return buf;
+    }
 
     void CheckStripChecksum(uint8_t* resp, size_t len) 
     {
@@ -90,26 +138,20 @@ namespace
         }, LOG_PREFIX);
     } 
 
-    void SendFastGroupReadRequest(TPort& port, TEnergomeraRegisterRange& range, const std::string& slaveId)
+    void SendFastGroupReadRequest(TPort& port, const TRegsByParam& regsByParam, const std::string& slaveId)
     {
-        // TODO: Exclude unavailable registers
         // request looks like this:
         //  Write [Energomera]:/?00000211!<SOH>R1<STX>GROUP(1001(1)1004(1)1008(1)4001(7))<ETX>	
 
-        char buf[128] = {};
-        // 4(header) + 1(crc)
-        char cmd_part[sizeof(buf) - 5] = {};
-        // 11 bytes of header
-        char query_part[sizeof(cmd_part) - 11] = {};
-        for (const auto & kv : range.ParamMasks) {
-            snprintf(query_part + strlen(query_part), sizeof(query_part) - strlen(query_part), "%04hX(%hX)", kv.first, kv.second); 
+        std::string query;
+        for (const auto & kv : regsByParam) {
+            query += GetParamQuery(kv.first, kv.second);
         }
 
-        snprintf(cmd_part, sizeof(cmd_part), "R1\x02GROUP(%s)\x03", query_part);
-        snprintf(buf, sizeof(buf), "/?%s!\x01%s", slaveId.data(), cmd_part);
-        // place checksum in place of trailing null byte
-        buf[strlen(buf)] = IEC::Get7BitSum((uint8_t*) (&cmd_part[0]), strlen(cmd_part));
-        IEC::WriteBytes(port, (uint8_t*) buf, strlen(buf), LOG_PREFIX);
+        std::string cmd_part = "R1\x02GROUP(" + query + ")\x03";
+        std::string buf = "/?" + slaveId + "!\x01" + cmd_part;
+        buf.push_back(IEC::Get7BitSum((const uint8_t*) cmd_part.data(), cmd_part.size()));
+        IEC::WriteBytes(port, (const uint8_t*) buf.data(), buf.size(), LOG_PREFIX);
     }
 
     /* @returns: null-terminated char* string which is a part of the input buffer. 
@@ -133,10 +175,11 @@ namespace
         return presp;
     }
 
-    void ProcessResponse(TEnergomeraRegisterRange& range, char* presp)
+    void ProcessResponse(const TRegsByParam& regsByParam, char* presp)
     {
+        // Errors of response contents are permanent, the meter will answer the same to the same request
         int nread;
-        for (const auto & kv : range.RegsByParam) {
+        for (const auto & kv : regsByParam) {
             auto & regs = kv.second;
             auto param_id = kv.first;
 
@@ -144,10 +187,10 @@ namespace
             uint16_t resp_param_id;
             int ret = sscanf(presp, "%04hX%n", &resp_param_id, &nread);
             if (ret < 1) {
-                throw TSerialDeviceTransientErrorException("param not found in the response");
+                throw TSerialDevicePermanentRegisterException("param not found in the response");
             }
             if (param_id != resp_param_id) {
-                throw TSerialDeviceTransientErrorException("response param ID doesn't match request");
+                throw TSerialDevicePermanentRegisterException("response param ID doesn't match request");
             }
             presp += nread;
 
@@ -179,8 +222,7 @@ namespace
                             }
                         }
                     } else {
-                        reg->SetError(ST_UNKNOWN_ERROR);
-                        throw TSerialDeviceTransientErrorException("Can't parse response");
+                        throw TSerialDevicePermanentRegisterException("Can't parse response");
                     }
                 }
             }
@@ -189,32 +231,87 @@ namespace
 }
 
 TEnergomeraIecWithFastReadDevice::TEnergomeraIecWithFastReadDevice(PDeviceConfig config, PPort port, PProtocol protocol)
-    : TIEC61107Device(config, port, protocol)
+    : TIEC61107Device(config, port, protocol), MaxResponseSize(DEFAULT_MAX_RESPONSE_SIZE)
 {}
 
-std::list<PRegisterRange> TEnergomeraIecWithFastReadDevice::ReadRegisterRange(PRegisterRange abstract_range)
+void TEnergomeraIecWithFastReadDevice::SetMaxResponseSize(size_t size)
+{
+    MaxResponseSize = size;
+}
+
+std::vector<PRegisterRange> TEnergomeraIecWithFastReadDevice::ReadRegisterRange(PRegisterRange abstract_range)
 {
     auto range  = std::dynamic_pointer_cast<TEnergomeraRegisterRange>(abstract_range);
     if (!range) {
         throw std::runtime_error("TEnergomeraRegisterRange expected");
     }
 
+    auto paramCount = GroupByParam(range->RegisterList(), true).size();
+    std::vector<PRegisterRange> newRanges;
+    ReadGroup(range, newRanges);
+
+    // Failing parameters are found by bisection and won't be requested anymore,
+    // so the rest can be read by a single request again
+    if (newRanges.size() > 1 && GroupByParam(range->RegisterList(), true).size() < paramCount) {
+        return {std::make_shared<TEnergomeraRegisterRange>(range->RegisterList())};
+    }
+    return newRanges;
+}
+
+void TEnergomeraIecWithFastReadDevice::ReadGroup(PRegisterRange range, std::vector<PRegisterRange>& newRanges)
+{
+    // Unsupported parameters are not requested
+    auto regsByParam = GroupByParam(range->RegisterList(), true);
+    if (regsByParam.empty()) {
+        newRanges.push_back(range);
+        return;
+    }
+
     Port()->SkipNoise();
     Port()->CheckPortOpen();
 
     try {
-        SendFastGroupReadRequest(*Port(), *range, SlaveId);
+        SendFastGroupReadRequest(*Port(), regsByParam, SlaveId);
 
         uint8_t resp[RESPONSE_BUF_LEN] = {};
         char* presp = ReadResponse(*Port(), resp, RESPONSE_BUF_LEN, *DeviceConfig());
 
-        ProcessResponse(*range, presp);
+        ProcessResponse(regsByParam, presp);
     } catch (TSerialDeviceTransientErrorException& e) {
         range->SetError(ST_UNKNOWN_ERROR);
         auto& logger = GetIsDisconnected() ? Debug : Warn;
         LOG(logger) << "TEnergomeraIecWithFastReadDevice::ReadRegisterRange(): " << e.what() << " [slave_id is " << ToString() + "]";
+    } catch (TSerialDevicePermanentRegisterException& e) {
+        if (regsByParam.size() == 1) {
+            for (auto reg: regsByParam.begin()->second) {
+                reg->SetAvailable(false);
+                reg->SetError(ST_DEVICE_ERROR);
+                LOG(Warn) << "TEnergomeraIecWithFastReadDevice::ReadRegisterRange(): " << e.what() << " [slave_id is "
+                          << ToString() + "] Register " << reg->ToString() << " is now marked as unsupported";
+            }
+            newRanges.push_back(range);
+            return;
+        }
+
+        // Find failing parameter by bisection, ranges with other parameters are read as usual.
+        // Registers of a range are ordered by parameter (see SplitRegisterList), so halves are sub-spans
+        LOG(Debug) << "TEnergomeraIecWithFastReadDevice::ReadRegisterRange(): " << e.what() << " [slave_id is "
+                   << ToString() + "] splitting group";
+        const auto& regs = range->RegisterList();
+        auto allRegsByParam = GroupByParam(regs, false);
+        size_t firstSize = 0;
+        size_t n = 0;
+        for (const auto& kv: allRegsByParam) {
+            if (n++ == allRegsByParam.size() / 2) {
+                break;
+            }
+            firstSize += kv.second.size();
+        }
+        ReadGroup(std::make_shared<TEnergomeraRegisterRange>(regs.Sub(0, firstSize)), newRanges);
+        ReadGroup(std::make_shared<TEnergomeraRegisterRange>(regs.Sub(firstSize, regs.size() - firstSize)), newRanges);
+        return;
     }
-    return { abstract_range };
+    newRanges.push_back(range);
 }
 
 void TEnergomeraIecWithFastReadDevice::WriteRegister(PRegister, uint64_t)
@@ -222,47 +319,56 @@ void TEnergomeraIecWithFastReadDevice::WriteRegister(PRegister, uint64_t)
     throw TSerialDeviceException("Energomera protocol: writing register is not supported");
 }
 
-std::list<PRegisterRange> TEnergomeraIecWithFastReadDevice::SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles) const
+std::vector<PRegisterRange> TEnergomeraIecWithFastReadDevice::SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles) const
 {
-    std::list<PRegisterRange> r;
-    if (reg_list.empty())
+    std::vector<PRegisterRange> r;
+    if (reg_list.empty()) {
         return r;
+    }
 
-    std::list<PRegister> sorted_reg_list = reg_list;
-    
-    sorted_reg_list.sort(
-        [](const PRegister& a, const  PRegister& b) -> bool {
-            if (a->PollInterval < b->PollInterval) return true;
-            if (a->PollInterval > b->PollInterval) return false;
-            
-            if (GetParamId(a) < GetParamId(b)) return true;
-            if (GetParamId(a) > GetParamId(b)) return false;
-
-            return false;
+    // Ranges are sub-spans of one span of registers ordered by poll interval, parameter and value number
+    std::vector<PRegister> sorted_reg_list(reg_list);
+    std::stable_sort(sorted_reg_list.begin(), sorted_reg_list.end(),
+        [](const PRegister& a, const PRegister& b) {
+            return std::make_tuple(a->GetConfig()->PollInterval, GetParamId(a), GetValueNum(a)) <
+                   std::make_tuple(b->GetConfig()->PollInterval, GetParamId(b), GetValueNum(b));
         }
     );
-
-    std::chrono::milliseconds prev_interval(-1);
-
-    std::list<PRegister> cur_range;
-    for (auto reg: sorted_reg_list) {
-        if ( (reg->PollInterval != prev_interval) || (cur_range.size() > 10)) {
-            prev_interval = reg->PollInterval;
-
-            if (!cur_range.empty()) {
-                auto range = std::make_shared<TEnergomeraRegisterRange>(cur_range);
-                r.push_back(range);
-                cur_range.clear();
-            }
+    TRegisterSpan regs(sorted_reg_list);
+
+    // Registers of a parameter are always in the same range.
+    // Request must fit into meter's buffer and estimated response must not exceed MaxResponseSize
+    size_t maxQueryLen = MAX_REQUEST_LEN - REQUEST_HEADER_LEN - SlaveId.size();
+    size_t start = 0;
+    size_t queryLen = 0;
+    size_t responseLen = RESPONSE_HEADER_LEN;
+    size_t paramStart = 0;
+    while (paramStart < regs.size()) {
+        const auto& first = regs[paramStart];
+        size_t paramEnd = paramStart + 1;
+        while (paramEnd < regs.size() &&
+               regs[paramEnd]->GetConfig()->PollInterval == first->GetConfig()->PollInterval &&
+               GetParamId(regs[paramEnd]) == GetParamId(first))
+        {
+            ++paramEnd;
         }
-        cur_range.push_back(reg);
-    }
-
-    if (!cur_range.empty()) {
-        auto range = std::make_shared<TEnergomeraRegisterRange>(cur_range);
-        r.push_back(range);
-        cur_range.clear();
+        auto param = regs.Sub(paramStart, paramEnd - paramStart);
+        auto paramQueryLen = GetParamQuery(GetParamId(first), param).size();
+        auto paramResponseLen = PARAM_ID_LEN + param.size() * MAX_VALUE_LEN;
+        if (paramStart != start &&
+            (first->GetConfig()->PollInterval != regs[start]->GetConfig()->PollInterval ||
+             queryLen + paramQueryLen > maxQueryLen ||
+             responseLen + paramResponseLen > MaxResponseSize))
+        {
+            r.push_back(std::make_shared<TEnergomeraRegisterRange>(regs.Sub(start, paramStart - start)));
+            start = paramStart;
+            queryLen = 0;
+            responseLen = RESPONSE_HEADER_LEN;
+        }
+        queryLen += paramQueryLen;
+        responseLen += paramResponseLen;
+        paramStart = paramEnd;
     }
-
+    r.push_back(std::make_shared<TEnergomeraRegisterRange>(regs.Sub(start, regs.size() - start)));
     return r;
 }
@@ -9,8 +9,26 @@ public:
     TEnergomeraIecWithFastReadDevice(PDeviceConfig device_config, PPort port, PProtocol protocol);
 
     void WriteRegister(PRegister reg, uint64_t value);
-    std::list<PRegisterRange> SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles = true) const override;
-    std::list<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles = true) const override;
+    std::vector<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
+
+    //! Maximum size of meter's response, group requests are built to get responses not longer than the size
+    void SetMaxResponseSize(size_t size);
 
     static void Register(TSerialDeviceFactory& factory);
+
+private:
+    /**
+     * @brief Read registers by one group request.
+     *        If the meter can't process the request, the group is split in halves,
+     *        and the halves are read separately, until failing parameter is found.
+     *        The parameter is marked as unsupported.
+     *        ReadRegisterRange joins the resulting ranges back, as the parameter is not requested anymore.
+     *
+     * @param range registers to read
+     * @param newRanges resulting ranges
+     */
+    void ReadGroup(PRegisterRange range, std::vector<PRegisterRange>& newRanges);
+
+    size_t MaxResponseSize;
 };
@@ -32,31 +32,14 @@ namespace
         { RegisterType::TIME,    "time",    "value", U32,    true }
     };
 
-    class TEnergomeraIecModeCDeviceFactory: public IDeviceFactory
-    {
-    public:
-        TEnergomeraIecModeCDeviceFactory()
-            : IDeviceFactory(std::make_unique<TStringRegisterAddressFactory>(),
-                             "#/definitions/simple_device_with_broadcast",
-                             "#/definitions/channel_with_string_address")
-        {}
-
-        PSerialDevice CreateDevice(const Json::Value& data,
-                                   PDeviceConfig      deviceConfig,
-                                   PPort              port,
-                                   PProtocol          protocol) const override
-        {
-            auto dev = std::make_shared<TEnergomeraIecModeCDevice>(deviceConfig, port, protocol);
-            dev->InitSetupItems();
-            return dev;
-        }
-    };
 }
 
 void TEnergomeraIecModeCDevice::Register(TSerialDeviceFactory& factory)
 {
     factory.RegisterProtocol(new TIEC61107Protocol("energomera_iec_mode_c", RegisterTypes),
-                             new TEnergomeraIecModeCDeviceFactory());
+                             new TIEC61107ModeCDeviceFactory<TEnergomeraIecModeCDevice>(std::make_unique<TStringRegisterAddressFactory>(),
+                                                                                        "#/definitions/iec_mode_c_device",
+                                                                                        "#/definitions/channel_with_string_address"));
 }
 
 TEnergomeraIecModeCDevice::TEnergomeraIecModeCDevice(PDeviceConfig device_config, PPort port, PProtocol protocol)
@@ -65,7 +48,7 @@ TEnergomeraIecModeCDevice::TEnergomeraIecModeCDevice(PDeviceConfig device_config
 
 std::string TEnergomeraIecModeCDevice::GetParameterRequest(const TRegister& reg) const
 {
-    return reg.GetAddress().ToString();
+    return reg.GetConfig()->GetAddress().ToString();
 }
 
 uint64_t TEnergomeraIecModeCDevice::GetRegisterValue(const TRegister& reg, const std::string& value)
@@ -76,7 +59,7 @@ uint64_t TEnergomeraIecModeCDevice::GetRegisterValue(const TRegister& reg, const
     }
     // Remove '(' and ")\r\n"
     auto v(value.substr(1, value.size() - 4));
-    switch (reg.Type)
+    switch (reg.GetConfig()->Type)
     {
         case RegisterType::DATE:
         {
@@ -93,7 +76,7 @@ uint64_t TEnergomeraIecModeCDevice::GetRegisterValue(const TRegister& reg, const
         }
         case RegisterType::DEFAULT:
         {
-            if (reg.Format == U64) {
+            if (reg.GetConfig()->Format == U64) {
                 return strtoull(v.c_str(), nullptr, 10);
             }
             return CopyDoubleToUint64(strtod(v.c_str(), nullptr));
@@ -105,8 +88,8 @@ uint64_t TEnergomeraIecModeCDevice::GetRegisterValue(const TRegister& reg, const
             // so we have here
             // 68.02)<CR><LF>(45.29)<CR><LF>(22.73)<CR><LF>(0.00)<CR><LF>(0.00)<CR><LF>(0.00
             auto items = WBMQTT::StringSplit(v, ")\r\n(");
-            if (items.size() > static_cast<unsigned int>(reg.Type)) {
-                return CopyDoubleToUint64(strtod(items[reg.Type].c_str(), nullptr));
+            if (items.size() > static_cast<unsigned int>(reg.GetConfig()->Type)) {
+                return CopyDoubleToUint64(strtod(items[reg.GetConfig()->Type].c_str(), nullptr));
             }
             throw TSerialDeviceTransientErrorException("malformed response");
         }
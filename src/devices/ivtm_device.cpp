@@ -128,10 +128,10 @@ uint64_t TIVTMDevice::ReadRegister(PRegister reg)
 {
     Port()->SkipNoise();
 
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
-    WriteCommand(SlaveId, addr, reg->GetByteWidth());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
+    WriteCommand(SlaveId, addr, reg->GetConfig()->GetByteWidth());
     uint8_t response[4];
-    ReadResponse(SlaveId, response, reg->GetByteWidth());
+    ReadResponse(SlaveId, response, reg->GetConfig()->GetByteWidth());
 
     uint8_t * p = response;//&response[(address % 2) * 4];
 
@@ -89,14 +89,14 @@ std::vector<uint8_t> TLLSDevice::ExecCommand(uint8_t cmd)
 
 uint64_t TLLSDevice::ReadRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     uint8_t cmd    = (addr & 0xFF00) >> 8;
     auto    result = ExecCommand(cmd);
 
     int result_buf[8] = {};
     uint8_t offset = (addr & 0x00FF);
 
-    for (int i=0; i< reg->GetByteWidth(); ++i) {
+    for (int i=0; i< reg->GetConfig()->GetByteWidth(); ++i) {
         result_buf[i] = result[offset+i];
     }
     
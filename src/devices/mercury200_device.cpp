@@ -63,12 +63,12 @@ std::vector<uint8_t> TMercury200Device::ExecCommand(uint8_t cmd)
 
 uint64_t TMercury200Device::ReadRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     uint8_t cmd = (addr & 0xFF00) >> 8;
     uint8_t offset = (addr & 0xFF);
 
     WordSizes size;
-    switch (reg->Type) {
+    switch (reg->GetConfig()->Type) {
     case REG_PARAM_VALUE32:
         size = WordSizes::W32_SZ;
         break;
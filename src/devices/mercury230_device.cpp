@@ -1,8 +1,13 @@
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <map>
 #include "mercury230_device.h"
 #include "crc16.h"
 #include "serial_config.h"
+#include "log.h"
+
+#define LOG(logger) logger.Log() << "[mercury230] "
 
 namespace
 {
@@ -15,13 +20,144 @@ namespace
         { TMercury230Device::REG_PARAM_SIGN_IGNORE, "param_sign_ignore",   "value",             U24, true },
         { TMercury230Device::REG_PARAM_BE,          "param_be",            "value",             S24, true }
     };
+
+    const uint8_t PARAM_CMD       = 0x08;
+    const uint8_t AUX_PARAM       = 0x11; // single auxiliary parameter value
+    const uint8_t AUX_PARAM_GROUP = 0x16; // auxiliary parameter values for all phases
+    const size_t  PARAM_SIZE      = 3;
+
+    // BWRI: high nibble - parameter, bits 2-3 - power type, bits 0-1 - phase number (0 - sum of phases)
+    const uint8_t BWRI_POWER   = 0x0;
+    const uint8_t BWRI_VOLTAGE = 0x1;
+    const uint8_t BWRI_CURRENT = 0x2;
+    const uint8_t BWRI_PF      = 0x3;
+    const uint8_t BWRI_ANGLE   = 0x5;
+
+    class TMercury230DeviceFactory: public IDeviceFactory
+    {
+    public:
+        TMercury230DeviceFactory()
+            : IDeviceFactory(std::make_unique<TUint32RegisterAddressFactory>(),
+                             "#/definitions/mercury230_device",
+                             "#/definitions/common_channel")
+        {}
+
+        PSerialDevice CreateDevice(const Json::Value& data,
+                                   PDeviceConfig      deviceConfig,
+                                   PPort              port,
+                                   PProtocol          protocol) const override
+        {
+            auto dev = std::make_shared<TMercury230Device>(deviceConfig, port, protocol);
+            bool groupParamReads = false;
+            WBMQTT::JSON::Get(data, "mercury230_group_reads", groupParamReads);
+            dev->SetGroupParamReads(groupParamReads);
+            dev->InitSetupItems();
+            return dev;
+        }
+    };
+
+    /**
+     * @brief Registers with values of the same parameter for different phases.
+     *        All values are read by one request with BWRI of the group.
+     */
+    class TMercury230ParamGroupRange: public TSimpleRegisterRange
+    {
+    public:
+        TMercury230ParamGroupRange(const TRegisterSpan& regs, uint8_t bwri, bool withSum)
+            : TSimpleRegisterRange(regs), Bwri(bwri), WithSum(withSum)
+        {}
+
+        //! BWRI of the request
+        uint8_t Bwri;
+
+        //! Response starts with the sum of phases, otherwise with phase 1
+        bool WithSum;
+    };
+
+    uint32_t GetParamAddress(const PRegister& reg)
+    {
+        return GetUint32RegisterAddress(reg->GetConfig()->GetAddress()) & 0xffff;
+    }
+
+    /**
+     * @brief Checks if register value can be read by group request.
+     *        Power and power factor are returned for sum of phases and for every phase,
+     *        voltage, current and angles between phases - for every phase.
+     */
+    bool IsGroupParam(const PRegister& reg)
+    {
+        switch (reg->GetConfig()->Type) {
+        case TMercury230Device::REG_PARAM:
+        case TMercury230Device::REG_PARAM_SIGN_ACT:
+        case TMercury230Device::REG_PARAM_SIGN_REACT:
+        case TMercury230Device::REG_PARAM_SIGN_IGNORE:
+            break;
+        default:
+            return false;
+        }
+        auto addr = GetParamAddress(reg);
+        if ((addr >> 8) != AUX_PARAM || reg->GetConfig()->GetByteWidth() != PARAM_SIZE) {
+            return false;
+        }
+        uint8_t bwri = addr & 0xff;
+        switch (bwri >> 4) {
+        case BWRI_POWER:
+            return true;
+        case BWRI_PF:
+            return (bwri & 0x0c) == 0;
+        case BWRI_VOLTAGE:
+        case BWRI_CURRENT:
+        case BWRI_ANGLE:
+            return (bwri & 0x0c) == 0 && (bwri & 0x03) != 0;
+        default:
+            return false;
+        }
+    }
+
+    uint32_t ParseParam(const uint8_t* buf, unsigned resp_payload_len, TMercury230Device::RegisterType reg_type)
+    {
+        if (resp_payload_len == 3) {
+            if ((reg_type == TMercury230Device::REG_PARAM_SIGN_ACT) ||
+                (reg_type == TMercury230Device::REG_PARAM_SIGN_REACT) ||
+                (reg_type == TMercury230Device::REG_PARAM_SIGN_IGNORE))
+            {
+                uint32_t magnitude = (((uint32_t)buf[0] & 0x3f) << 16) +
+                                    ((uint32_t)buf[2] << 8) +
+                                    (uint32_t)buf[1];
+
+                int active_power_sign =   (buf[0] & (1 << 7)) ? -1 : 1;
+                int reactive_power_sign = (buf[0] & (1 << 6)) ? -1 : 1;
+
+                int sign = 1;
+
+                if (reg_type == TMercury230Device::REG_PARAM_SIGN_ACT) {
+                        sign = active_power_sign;
+                } else if (reg_type == TMercury230Device::REG_PARAM_SIGN_REACT) {
+                        sign = reactive_power_sign;
+                }
+
+                return (uint32_t)(((int32_t) magnitude * sign));
+            } else {
+                return ((uint32_t)buf[0] << 16) +
+                       ((uint32_t)buf[2] << 8) +
+                       (uint32_t)buf[1];
+            }
+        } else  {
+            if (reg_type == TMercury230Device::REG_PARAM_BE) {
+                return ((uint32_t)buf[0] << 8) +
+                       ((uint32_t)buf[1]);
+            } else {
+                return ((uint32_t)buf[1] << 8) +
+                       ((uint32_t)buf[0]);
+           }
+        }
+    }
 }
 
 void TMercury230Device::Register(TSerialDeviceFactory& factory)
 {
     factory.RegisterProtocol(new TUint32SlaveIdProtocol("mercury230", RegisterTypes, true),
-                             new TBasicDeviceFactory<TMercury230Device>("#/definitions/simple_device_with_broadcast",
-                                                                        "#/definitions/common_channel"));
+                             new TMercury230DeviceFactory());
 }
 
 TMercury230Device::TMercury230Device(PDeviceConfig device_config, PPort port, PProtocol protocol)
@@ -52,6 +188,10 @@ TMercury230Device::TMercury230Device(PDeviceConfig device_config, PPort port, PP
     const std::chrono::milliseconds minTimeout(150); 
     auto timeout = std::max(minTimeout, std::chrono::milliseconds(115) + port->GetSendTime(35));
     device_config->ResponseTimeout = std::max(device_config->FrameTimeout, timeout);
+
+    // Meter closes the channel after 240 s without requests, reopen it a bit earlier
+    // to avoid extra request with "Connection closed" response
+    SessionTimeout = std::chrono::seconds(230);
 }
 
 bool TMercury230Device::ConnectionSetup( )
@@ -137,46 +277,14 @@ uint32_t TMercury230Device::ReadParam( uint32_t address, unsigned resp_payload_l
 
     assert(resp_payload_len <= 3);
     uint8_t buf[3] = {};
-    Talk( 0x08, cmdBuf, 2, -1, buf, resp_payload_len);
-
-    if (resp_payload_len == 3) {
-        if ((reg_type == REG_PARAM_SIGN_ACT) || (reg_type == REG_PARAM_SIGN_REACT) || (reg_type == REG_PARAM_SIGN_IGNORE)) {
-            uint32_t magnitude = (((uint32_t)buf[0] & 0x3f) << 16) +
-                                ((uint32_t)buf[2] << 8) +
-                                (uint32_t)buf[1];
-
-            int active_power_sign =   (buf[0] & (1 << 7)) ? -1 : 1;
-            int reactive_power_sign = (buf[0] & (1 << 6)) ? -1 : 1;
-
-            int sign = 1;
-
-            if (reg_type == REG_PARAM_SIGN_ACT) {
-                    sign = active_power_sign;
-            } else if (reg_type == REG_PARAM_SIGN_REACT) {
-                    sign = reactive_power_sign;
-            }
-
-            return (uint32_t)(((int32_t) magnitude * sign));
-        } else {
-            return ((uint32_t)buf[0] << 16) +
-                   ((uint32_t)buf[2] << 8) +
-                   (uint32_t)buf[1];
-        }
-    } else  {
-        if (reg_type == REG_PARAM_BE) {
-            return ((uint32_t)buf[0] << 8) +
-                   ((uint32_t)buf[1]);
-        } else {
-            return ((uint32_t)buf[1] << 8) +
-                   ((uint32_t)buf[0]);
-       }
-    }
+    Talk( PARAM_CMD, cmdBuf, 2, -1, buf, resp_payload_len);
+    return ParseParam(buf, resp_payload_len, reg_type);
 }
 
 uint64_t TMercury230Device::ReadRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
-    switch (reg->Type) {
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
+    switch (reg->GetConfig()->Type) {
     case REG_VALUE_ARRAY:
         return ReadValueArray(addr, 4).values[addr & 0x03];
     case REG_VALUE_ARRAY12:
@@ -186,12 +294,97 @@ uint64_t TMercury230Device::ReadRegister(PRegister reg)
     case REG_PARAM_SIGN_REACT:
     case REG_PARAM_SIGN_IGNORE:
     case REG_PARAM_BE:
-        return ReadParam( addr & 0xffff, reg->GetByteWidth(), (RegisterType) reg->Type);
+        return ReadParam( addr & 0xffff, reg->GetConfig()->GetByteWidth(), (RegisterType) reg->GetConfig()->Type);
     default:
         throw TSerialDeviceException("mercury230: invalid register type");
     }
 }
 
+std::vector<PRegisterRange> TMercury230Device::SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles) const
+{
+    if (!GroupParamReads) {
+        return TSerialDevice::SplitRegisterList(reg_list, enableHoles);
+    }
+
+    // Values of the same parameter for different phases with the same poll interval are read by one request.
+    // Registers are ordered so that groups are sub-spans of one span
+    std::vector<PRegisterRange> r;
+    std::vector<PRegister> groupRegs;
+    for (auto reg: reg_list) {
+        if (IsGroupParam(reg)) {
+            groupRegs.push_back(reg);
+        } else {
+            r.push_back(std::make_shared<TSimpleRegisterRange>(reg));
+        }
+    }
+    if (groupRegs.empty()) {
+        return r;
+    }
+    auto groupKey = [](const PRegister& reg) {
+        return std::make_pair(reg->GetConfig()->PollInterval, GetParamAddress(reg) & 0xfc);
+    };
+    std::stable_sort(groupRegs.begin(), groupRegs.end(), [&](const PRegister& a, const PRegister& b) {
+        return groupKey(a) < groupKey(b);
+    });
+    TRegisterSpan regs(groupRegs);
+    size_t start = 0;
+    for (size_t i = 1; i <= regs.size(); ++i) {
+        if (i < regs.size() && groupKey(regs[i]) == groupKey(regs[start])) {
+            continue;
+        }
+        if (i - start == 1) {
+            r.push_back(std::make_shared<TSimpleRegisterRange>(regs[start]));
+        } else {
+            uint8_t group = groupKey(regs[start]).second;
+            uint8_t param = group >> 4;
+            bool withSum = (param == BWRI_POWER || param == BWRI_PF);
+            uint8_t bwri = withSum ? group : group | 0x01;
+            r.push_back(std::make_shared<TMercury230ParamGroupRange>(regs.Sub(start, i - start), bwri, withSum));
+        }
+        start = i;
+    }
+    return r;
+}
+
+std::vector<PRegisterRange> TMercury230Device::ReadRegisterRange(PRegisterRange range)
+{
+    auto group = std::dynamic_pointer_cast<TMercury230ParamGroupRange>(range);
+    if (!group || !GroupParamReads) {
+        return TSerialDevice::ReadRegisterRange(range);
+    }
+
+    try {
+        Port()->SleepSinceLastInteraction(DeviceConfig()->RequestDelay);
+        uint8_t cmdBuf[2] = { AUX_PARAM_GROUP, group->Bwri };
+        size_t valuesCount = group->WithSum ? 4 : 3;
+        uint8_t buf[4 * PARAM_SIZE] = {};
+        Talk(PARAM_CMD, cmdBuf, 2, -1, buf, valuesCount * PARAM_SIZE);
+        for (auto reg: group->RegisterList()) {
+            size_t index = GetParamAddress(reg) & 0x03;
+            if (!group->WithSum) {
+                --index;
+            }
+            reg->SetValue(ParseParam(buf + index * PARAM_SIZE, PARAM_SIZE, (RegisterType) reg->GetConfig()->Type));
+        }
+    } catch (const TSerialDeviceTransientErrorException& e) {
+        range->SetError(ST_UNKNOWN_ERROR);
+        auto& logger = GetIsDisconnected() ? Debug : Warn;
+        LOG(logger) << "TMercury230Device::ReadRegisterRange(): " << e.what() << " [slave_id is " << ToString() + "]";
+    } catch (const TSerialDevicePermanentRegisterException& e) {
+        // Old meters don't support reading of all phases at once
+        LOG(Warn) << "TMercury230Device::ReadRegisterRange(): " << e.what() << " [slave_id is " << ToString()
+                  << "] group reads of parameters are disabled";
+        GroupParamReads = false;
+        return TSerialDevice::ReadRegisterRange(range);
+    }
+    return {range};
+}
+
+void TMercury230Device::SetGroupParamReads(bool groupParamReads)
+{
+    GroupParamReads = groupParamReads;
+}
+
 void TMercury230Device::EndPollCycle()
 {
     CachedValues.clear();
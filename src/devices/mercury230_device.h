@@ -28,6 +28,12 @@ public:
     uint64_t ReadRegister(PRegister reg);
     void EndPollCycle();
 
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles = true) const override;
+    std::vector<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
+
+    //! Read all phases of a parameter by one request (parameter 0x16 of command 0x08)
+    void SetGroupParamReads(bool groupParamReads);
+
     static void Register(TSerialDeviceFactory& factory);
 
 protected:
@@ -42,6 +48,7 @@ private:
     uint32_t ReadParam( uint32_t address, unsigned resp_payload_len, RegisterType reg_type);
 
     std::unordered_map<int, TValueArray> CachedValues;
+    bool GroupParamReads = false;
 };
 
 typedef std::shared_ptr<TMercury230Device> PMercury230Device;
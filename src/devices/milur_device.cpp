@@ -129,8 +129,8 @@ TEMDevice::ErrorType TMilurDevice::CheckForException(uint8_t* frame, int len, co
 
 uint64_t TMilurDevice::ReadRegister(PRegister reg)
 {
-    uint8_t addr = GetUint32RegisterAddress(reg->GetAddress());
-    int size = GetExpectedSize(reg->Type);
+    uint8_t addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
+    int size = GetExpectedSize(reg->GetConfig()->Type);
     uint8_t buf[MAX_LEN], *p = buf;
     Talk(0x01, &addr, 1, 0x01, buf, size + 2, ExpectNBytes(SlaveIdWidth, size + 5 + SlaveIdWidth));
     if (*p++ != addr)
@@ -138,7 +138,7 @@ uint64_t TMilurDevice::ReadRegister(PRegister reg)
     if (*p != size)
         throw TSerialDeviceTransientErrorException("bad register size in the response");
 
-    switch (reg->Type) {
+    switch (reg->GetConfig()->Type) {
     case TMilurDevice::REG_PARAM:
         return BuildIntVal(buf + 2, 3);
     case TMilurDevice::REG_POWER:
@@ -44,7 +44,7 @@ TModbusDevice::TModbusDevice(std::unique_ptr<Modbus::IModbusTraits> modbusTraits
     config->FrameTimeout = std::max(config->FrameTimeout, port->GetSendTime(3.5));
 }
 
-std::list<PRegisterRange> TModbusDevice::SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles) const
+std::vector<PRegisterRange> TModbusDevice::SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles) const
 {
     return Modbus::SplitRegisterList(reg_list, *DeviceConfig(), enableHoles);
 }
@@ -54,7 +54,7 @@ void TModbusDevice::WriteRegister(PRegister reg, uint64_t value)
     Modbus::WriteRegister(*ModbusTraits, *Port(), SlaveId, *reg, value);
 }
 
-std::list<PRegisterRange> TModbusDevice::ReadRegisterRange(PRegisterRange range)
+std::vector<PRegisterRange> TModbusDevice::ReadRegisterRange(PRegisterRange range)
 {
     return Modbus::ReadRegisterRange(*ModbusTraits, *Port(), SlaveId, range);
 }
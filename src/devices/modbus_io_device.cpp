@@ -59,7 +59,7 @@ TModbusIODevice::TModbusIODevice(std::unique_ptr<Modbus::IModbusTraits> modbusTr
     config->FrameTimeout = std::max(config->FrameTimeout, port->GetSendTime(3.5));
 }
 
-std::list<PRegisterRange> TModbusIODevice::SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles) const
+std::vector<PRegisterRange> TModbusIODevice::SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles) const
 {
     return Modbus::SplitRegisterList(reg_list, *DeviceConfig(), enableHoles);
 }
@@ -69,7 +69,7 @@ void TModbusIODevice::WriteRegister(PRegister reg, uint64_t value)
     Modbus::WriteRegister(*ModbusTraits, *Port(), SlaveId, *reg, value, Shift);
 }
 
-std::list<PRegisterRange> TModbusIODevice::ReadRegisterRange(PRegisterRange range)
+std::vector<PRegisterRange> TModbusIODevice::ReadRegisterRange(PRegisterRange range)
 {
     return Modbus::ReadRegisterRange(*ModbusTraits, *Port(), SlaveId, range, Shift);
 }
@@ -16,9 +16,9 @@ class TModbusIODevice : public TSerialDevice, public TUInt32SlaveId
 
 public:
     TModbusIODevice(std::unique_ptr<Modbus::IModbusTraits> modbusTraits, PDeviceConfig config, PPort port, PProtocol protocol);
-    std::list<PRegisterRange> SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles = true) const override;
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles = true) const override;
     void WriteRegister(PRegister reg, uint64_t value) override;
-    std::list<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
+    std::vector<PRegisterRange> ReadRegisterRange(PRegisterRange range) override;
     bool WriteSetupRegisters() override;
 
     static void Register(TSerialDeviceFactory& factory);
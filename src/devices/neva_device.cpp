@@ -64,8 +64,9 @@ namespace
 void TNevaDevice::Register(TSerialDeviceFactory& factory)
 {
     factory.RegisterProtocol(new TIEC61107Protocol("neva", RegisterTypes), 
-                             new TBasicDeviceFactory<TNevaDevice>("#/definitions/simple_device_with_broadcast",
-                                                                  "#/definitions/common_channel"));
+                             new TIEC61107ModeCDeviceFactory<TNevaDevice>(std::make_unique<TUint32RegisterAddressFactory>(),
+                                                                          "#/definitions/iec_mode_c_device",
+                                                                          "#/definitions/common_channel"));
 }
 
 TNevaDevice::TNevaDevice(PDeviceConfig device_config, PPort port, PProtocol protocol)
@@ -76,12 +77,26 @@ std::string TNevaDevice::GetParameterRequest(const TRegister& reg) const
 {
     // Address is 0xCCDDEEFF OBIS value groups
     std::stringstream ss;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << GetUint32RegisterAddress(reg.GetAddress()) << "()";
+    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(8) << GetUint32RegisterAddress(reg.GetConfig()->GetAddress()) << "()";
     return ss.str();
 }
 
-uint64_t TNevaDevice::GetRegisterValue(const TRegister& reg, const std::string& v)
+std::string TNevaDevice::GetDataReadoutAddress(const TRegister& reg) const
 {
+    // Address is 0xCCDDEEFF OBIS value groups, data readout uses C.D.E or C.D.E*F notation
+    auto addr = GetUint32RegisterAddress(reg.GetConfig()->GetAddress());
+    std::stringstream ss;
+    ss << ((addr >> 24) & 0xFF) << "." << ((addr >> 16) & 0xFF) << "." << ((addr >> 8) & 0xFF);
+    if ((addr & 0xFF) != 0xFF) {
+        ss << "*" << (addr & 0xFF);
+    }
+    return ss.str();
+}
+
+uint64_t TNevaDevice::GetRegisterValue(const TRegister& reg, const std::string& response)
+{
+    // Lines of data readout end with <CR><LF>
+    std::string v(WBMQTT::StringHasSuffix(response, "\r\n") ? response.substr(0, response.size() - 2) : response);
     if (v.size() < 3 || v.front() != '(' || v.back() != ')') {
         throw TSerialDeviceTransientErrorException("malformed response");
     }
@@ -90,7 +105,7 @@ uint64_t TNevaDevice::GetRegisterValue(const TRegister& reg, const std::string&
     int ret = sscanf(value.c_str(), "%lf,%lf,%lf,%lf,%lf", &result[0], &result[1], &result[2], &result[3], &result[4]);
     result.resize(ret);
 
-    size_t val_index = RegisterTypeValueIndices[reg.TypeName];
+    size_t val_index = RegisterTypeValueIndices[reg.GetConfig()->TypeName];
     
     if (result.size() < val_index + 1) {
         throw TSerialDeviceTransientErrorException("not enough data in response");
@@ -98,14 +113,14 @@ uint64_t TNevaDevice::GetRegisterValue(const TRegister& reg, const std::string&
 
     auto val = result[val_index];
 
-    if (reg.TypeName == "power_factor" || reg.TypeName == "obis_cdef_pf") {
+    if (reg.GetConfig()->TypeName == "power_factor" || reg.GetConfig()->TypeName == "obis_cdef_pf") {
         // Y: 0, 1 or 2     (C, L or ?)	YХ.ХХХ
         if (val >= 20) {
             val-=20;
         } else if (val >= 10) {
             val = -(val-10);
         }
-    } else if (reg.TypeName == "temperature" || reg.TypeName == "obis_cdef_temp") {
+    } else if (reg.GetConfig()->TypeName == "temperature" || reg.GetConfig()->TypeName == "obis_cdef_temp") {
         if (val >= 100.0) {
             val = -(val - 100.0);
         }
@@ -13,4 +13,5 @@ public:
 private:
     std::string GetParameterRequest(const TRegister& reg) const override;
     uint64_t    GetRegisterValue(const TRegister& reg, const std::string& value) override;
+    std::string GetDataReadoutAddress(const TRegister& reg) const override;
 };
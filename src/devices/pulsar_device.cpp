@@ -187,7 +187,7 @@ void TPulsarDevice::ReadResponse(uint32_t addr, uint8_t *payload, size_t size, u
 
 uint64_t TPulsarDevice::ReadDataRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     // raw payload data
     uint8_t payload[sizeof (uint64_t)];
 
@@ -196,12 +196,12 @@ uint64_t TPulsarDevice::ReadDataRegister(PRegister reg)
 
     // send data request and receive response
     WriteDataRequest(SlaveId, mask, RequestID);
-    ReadResponse(SlaveId, payload, reg->GetByteWidth(), RequestID);
+    ReadResponse(SlaveId, payload, reg->GetConfig()->GetByteWidth(), RequestID);
 
     ++RequestID;
 
     // decode little-endian double64_t value
-    return ReadHex(payload, reg->GetByteWidth(), false);
+    return ReadHex(payload, reg->GetConfig()->GetByteWidth(), false);
 }
 
 uint64_t TPulsarDevice::ReadSysTimeRegister(PRegister reg)
@@ -223,7 +223,7 @@ uint64_t TPulsarDevice::ReadRegister(PRegister reg)
 {
     Port()->SkipNoise();
 
-    switch (reg->Type) {
+    switch (reg->GetConfig()->Type) {
     case REG_DEFAULT:
         return ReadDataRegister(reg);
     case REG_SYSTIME: // TODO: think about return value
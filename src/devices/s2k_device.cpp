@@ -73,8 +73,8 @@ uint8_t TS2KDevice::CrcS2K(const uint8_t *array, int size)
 // and error handling into separate function
 void TS2KDevice::WriteRegister(PRegister reg, uint64_t value)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
-    if (reg->Type != REG_RELAY) {
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
+    if (reg->GetConfig()->Type != REG_RELAY) {
         throw TSerialDeviceException("S2K protocol: invalid register for writing");
     }
 
@@ -113,10 +113,10 @@ void TS2KDevice::WriteRegister(PRegister reg, uint64_t value)
 // and error handling into separate function
 uint64_t TS2KDevice::ReadRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     /* We have no way to get current relay state from device. Thats why we save last
        successful write to relay register and return it when regiter is read */
-    switch (reg->Type) {
+    switch (reg->GetConfig()->Type) {
     case REG_RELAY:
         return RelayState[addr] != 0 && RelayState[addr] != 2;
     case REG_RELAY_MODE:
@@ -132,7 +132,7 @@ uint64_t TS2KDevice::ReadRegister(PRegister reg)
                 /* Command length = */0x06,
                 /* Key = */0x00,
                 /* Command = */0x05,/* Read configutation */
-                /* Config No = */(uint8_t)(addr + (reg->Type == REG_RELAY_DELAY ? 4 : 0)),
+                /* Config No = */(uint8_t)(addr + (reg->GetConfig()->Type == REG_RELAY_DELAY ? 4 : 0)),
                 /* Unused */0x0,
                 /* CRC placeholder */0x0
             };
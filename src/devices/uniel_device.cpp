@@ -95,29 +95,29 @@ void TUnielDevice::ReadResponse(uint8_t cmd, uint8_t* response)
 
 uint64_t TUnielDevice::ReadRegister(PRegister reg)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     WriteCommand(READ_CMD, SlaveId, 0, uint8_t(addr), 0);
     uint8_t response[3] = {0};
     ReadResponse(READ_CMD, response);
     if (response[1] != uint8_t(addr))
         throw TSerialDeviceTransientErrorException("register index mismatch");
 
-    if (reg->Type == REG_RELAY)
+    if (reg->GetConfig()->Type == REG_RELAY)
         return response[0] ? 1 : 0;
     return response[0];
 }
 
 void TUnielDevice::WriteRegister(PRegister reg, uint64_t value)
 {
-    auto addr = GetUint32RegisterAddress(reg->GetAddress());
+    auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
     uint8_t cmd;
-    if (reg->Type == REG_BRIGHTNESS) {
+    if (reg->GetConfig()->Type == REG_BRIGHTNESS) {
         cmd = SET_BRIGHTNESS_CMD;
         addr >>= 8;
     } else {
         cmd = WRITE_CMD;
     }
-    if (reg->Type == REG_RELAY && value != 0)
+    if (reg->GetConfig()->Type == REG_RELAY && value != 0)
         value = 255;
     WriteCommand(cmd, SlaveId, value, addr, 0);
     uint8_t response[3];
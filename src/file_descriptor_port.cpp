@@ -5,8 +5,9 @@
 #include <unistd.h>
 #include <iomanip>
 #include <iostream>
-#include <sys/select.h>
-#include <sys/ioctl.h>
+#include <poll.h>
+#include <string.h>
+#include <algorithm>
 
 #include "log.h"
 
@@ -18,10 +19,17 @@ namespace {
     const chrono::milliseconds NoiseTimeout(10);
     const chrono::milliseconds ContinuousNoiseTimeout(100);
     const int ContinuousNoiseReopenNumber = 3;
+
+    // Enough for several frames of any supported protocol
+    const size_t RxBufferSize = 4096;
 }
 
 TFileDescriptorPort::TFileDescriptorPort()
-    : Fd(-1)
+    : Fd(-1),
+      Trace(std::make_shared<TFrameTrace>()),
+      RxBuffer(RxBufferSize),
+      RxBegin(0),
+      RxEnd(0)
 {}
 
 TFileDescriptorPort::~TFileDescriptorPort()
@@ -36,6 +44,7 @@ void TFileDescriptorPort::Close()
     CheckPortOpen();
     close(Fd);
     Fd = -1;
+    RxBegin = RxEnd = 0;
 }
 
 bool TFileDescriptorPort::IsOpen() const
@@ -63,31 +72,29 @@ void TFileDescriptorPort::WriteBytes(const uint8_t * buf, int count) {
 
     LastInteraction = std::chrono::steady_clock::now();
 
-    if (::Debug.IsEnabled()) {
-        // TBD: move this to libwbmqtt (HexDump?)
-        stringstream ss;
-        ss << "Write:" << hex << setfill('0');
-        for (int i = 0; i < count; ++i) {
-            ss << " " << setw(2) << int(buf[i]);
-        }
-        LOG(Debug) << ss.str();
-    }
+    Trace->Push(TFrameDirection::Write, buf, count);
 }
 
 bool TFileDescriptorPort::Select(const chrono::microseconds& us)
 {
-    fd_set rfds;
-    struct timeval tv, *tvp = 0;
+    if (RxBegin != RxEnd) {
+        return true;
+    }
+
+    pollfd pfd;
+    pfd.fd = Fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
 
-    FD_ZERO(&rfds);
-    FD_SET(Fd, &rfds);
+    // Non-positive timeout means waiting forever
+    timespec ts, *tsp = nullptr;
     if (us.count() > 0) {
-        tv.tv_sec = us.count() / 1000000;
-        tv.tv_usec = us.count() % 1000000;
-        tvp = &tv;
+        ts.tv_sec = us.count() / 1000000;
+        ts.tv_nsec = (us.count() % 1000000) * 1000;
+        tsp = &ts;
     }
 
-    int r = select(Fd + 1, &rfds, NULL, NULL, tvp);
+    int r = ppoll(&pfd, 1, tsp, nullptr);
     if (r < 0) {
         throw TSerialDeviceException("TFileDescriptorPort::Select() failed " + to_string(errno));
     }
@@ -98,6 +105,11 @@ bool TFileDescriptorPort::Select(const chrono::microseconds& us)
 void TFileDescriptorPort::OnReadyEmptyFd()
 {}
 
+bool TFileDescriptorPort::HasBufferedData() const
+{
+    return RxBegin != RxEnd;
+}
+
 uint8_t TFileDescriptorPort::ReadByte(const chrono::microseconds& timeout)
 {
     CheckPortOpen();
@@ -107,48 +119,43 @@ uint8_t TFileDescriptorPort::ReadByte(const chrono::microseconds& timeout)
     }
 
     uint8_t b;
-    if (read(Fd, &b, 1) < 1) {
+    if (ReadAvailableData(&b, 1) < 1) {
         throw TSerialDeviceException("read() failed");
     }
 
     LastInteraction = std::chrono::steady_clock::now();
 
-    LOG(Debug) << "Read: " << hex << setw(2) << setfill('0') << int(b);
+    Trace->Push(TFrameDirection::Read, &b, 1);
 
     return b;
 }
 
 size_t TFileDescriptorPort::ReadAvailableData(uint8_t * buf, size_t max_read)
 {
-    // We don't want to use non-blocking IO in general
-    // (e.g. we want blocking writes), but we don't want
-    // read() call below to block because actual frame
-    // size is not known at this point. So we must
-    // know how many bytes are available
-    int nb = 0;
-    if (ioctl(Fd, FIONREAD, &nb) < 0) {
-        throw TSerialDeviceException("FIONREAD ioctl() failed");
-    }
-
-    // Got Fd as ready for read from select, but no actual data to read
-    if (!nb) {
-        OnReadyEmptyFd();
-        return 0;
-    }
-
-    if (nb >= 0 && static_cast<size_t>(nb) > max_read) {
-        nb = max_read;
-    }
-
-    int n = read(Fd, buf, nb);
-    if (n < 0) {
-        throw TSerialDeviceException("read() failed");
-    }
+    if (RxBegin == RxEnd) {
+        // Fd is ready for reading, so read() doesn't block: ttys are set up with VMIN = 0 and VTIME = 0,
+        // sockets return what is already received. One call takes all available data
+        auto n = read(Fd, RxBuffer.data(), RxBuffer.size());
+        if (n < 0) {
+            // Spurious wakeup of non-blocking descriptor
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return 0;
+            }
+            throw TSerialDeviceException("read() failed");
+        }
 
-    if (n < nb) { // may happen only due to a kernel/driver bug
-        throw TSerialDeviceException("short read()");
+        // Got Fd as ready for read from select, but no actual data to read
+        if (n == 0) {
+            OnReadyEmptyFd();
+            return 0;
+        }
+        RxBegin = 0;
+        RxEnd = n;
     }
 
+    size_t nb = std::min(max_read, RxEnd - RxBegin);
+    memcpy(buf, RxBuffer.data() + RxBegin, nb);
+    RxBegin += nb;
     return nb;
 }
 
@@ -179,6 +186,10 @@ size_t TFileDescriptorPort::ReadFrame(uint8_t * buf,
             continue;
         }
 
+        if (nread == 0) {
+            LastFrameStart = std::chrono::steady_clock::now();
+        }
+
         // Got something, switch to frameTimeout to detect frame boundary
         // Delay between bytes in one message can't be more than frameTimeout
         selectTimeout = frameTimeout;
@@ -191,15 +202,7 @@ size_t TFileDescriptorPort::ReadFrame(uint8_t * buf,
 
     LastInteraction = std::chrono::steady_clock::now();
 
-    if (::Debug.IsEnabled()) {
-        // TBD: move this to libwbmqtt (HexDump?)
-        stringstream ss;
-        ss << "ReadFrame:" << hex << setfill('0');
-        for (size_t i = 0; i < nread; ++i) {
-            ss << " " << setw(2) << int(buf[i]);
-        }
-        LOG(Debug) << ss.str();
-    }
+    Trace->Push(TFrameDirection::Read, buf, nread);
 
     return nread;
 }
@@ -214,24 +217,18 @@ void TFileDescriptorPort::SkipNoise()
         size_t nread = ReadAvailableData(buf, sizeof(buf) / sizeof(buf[0]));
         auto diff = std::chrono::steady_clock::now() - start;
 
-        if (::Debug.IsEnabled()) {
-            // TBD: move this to libwbmqtt (HexDump?)
-            stringstream ss;
-            ss << "read noise: " << hex << setfill('0');
-            for (size_t i = 0; i < nread; ++i) {
-                ss << " " << setw(2) << int(buf[i]);
-            }
-            LOG(Debug) << ss.str();
-        }
-
         // if we are still getting data for already "ContinuousNoiseTimeout" milliseconds
         if (nread > 0) {
             LastInteraction = std::chrono::steady_clock::now();
+            Trace->Push(TFrameDirection::Noise, buf, nread);
 
             if (diff > ContinuousNoiseTimeout) {
                 if (ntries < ContinuousNoiseReopenNumber)  {
                     LOG(Debug) << "continuous unsolicited data flow detected, reopen the port";
                     Reopen();
+                    if (!IsOpen()) {
+                        throw TSerialDeviceTransientErrorException("port is reconnecting");
+                    }
                     ntries += 1;
                     start = std::chrono::steady_clock::now();
                 } else {
@@ -264,3 +261,8 @@ TTimePoint TFileDescriptorPort::CurrentTime() const
 {
     return chrono::steady_clock::now();
 }
+
+PFrameTrace TFileDescriptorPort::GetFrameTrace() const
+{
+    return Trace;
+}
@@ -2,6 +2,8 @@
 
 #include "port.h"
 
+#include <vector>
+
 /*!
  * Abstract port class for file descriptor based ports implementation
  */
@@ -27,21 +29,44 @@ public:
     bool Wait(const PBinarySemaphore& semaphore, const TTimePoint& until) override;
     TTimePoint CurrentTime() const override;
 
+    PFrameTrace GetFrameTrace() const override;
+
 protected:
+    /**
+     * @brief Wait for data to read.
+     *
+     * @return true if there is buffered data or the descriptor is ready for reading, false on timeout
+     */
     bool Select(const std::chrono::microseconds& us);
     virtual void OnReadyEmptyFd();
 
+    //! Returns true if receive buffer contains data not yet consumed by read functions
+    bool HasBufferedData() const;
+
     int             Fd;
     std::chrono::time_point<std::chrono::steady_clock> LastInteraction;
+    //! Time of receiving first bytes of last frame read by ReadFrame
+    std::chrono::time_point<std::chrono::steady_clock> LastFrameStart;
+    PFrameTrace     Trace;
 private:
     /**
-     * @brief Reads data from port. Throws TSerialDeviceException on errors
+     * @brief Reads data from port. Data is taken from receive buffer,
+     *        the buffer is refilled by a single read() of all available bytes when empty.
+     *        Throws TSerialDeviceException on errors
      * 
      * @param buf buffer to read to
      * @param max_read maximum bytes to read
      * @return size_t actual read bytes number
      */
     size_t ReadAvailableData(uint8_t* buf, size_t max_read);
+
+    /*
+     * Receive buffer. It is refilled only after all data is consumed,
+     * so it never wraps and [RxBegin, RxEnd) is the unread data.
+     */
+    std::vector<uint8_t> RxBuffer;
+    size_t               RxBegin;
+    size_t               RxEnd;
 };
 
 
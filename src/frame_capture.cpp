@@ -0,0 +1,208 @@
+#include "frame_capture.h"
+#include "serial_exc.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    const char    Signature[]      = "WBSCAP02";
+    const size_t  SignatureSize    = sizeof(Signature) - 1;
+    const size_t  RecordHeaderSize = 12;
+    const uint8_t TruncatedFlag    = 0x80;
+
+    void PutUint(uint8_t* p, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i) {
+            p[i] = (value >> (8 * i)) & 0xFF;
+        }
+    }
+
+    uint64_t GetUint(const uint8_t* p, size_t size)
+    {
+        uint64_t res = 0;
+        for (size_t i = 0; i < size; ++i) {
+            res |= uint64_t(p[i]) << (8 * i);
+        }
+        return res;
+    }
+}
+
+TFrameCaptureWriter::TFrameCaptureWriter(const string& fileName, size_t maxFileSize)
+    : FileName(fileName),
+      MaxFileSize(maxFileSize),
+      Fd(-1),
+      Map(nullptr),
+      Size(0)
+{
+    if (MaxFileSize < SignatureSize + RecordHeaderSize + UINT16_MAX) {
+        throw runtime_error("capture file size is too small");
+    }
+    OpenFile();
+}
+
+TFrameCaptureWriter::~TFrameCaptureWriter()
+{
+    CloseFile();
+}
+
+void TFrameCaptureWriter::OpenFile()
+{
+    Fd = open(FileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (Fd < 0) {
+        throw runtime_error("can't open capture file " + FileName + " " + FormatErrno(errno));
+    }
+    if (ftruncate(Fd, MaxFileSize) < 0) {
+        auto err = errno;
+        CloseFile();
+        throw runtime_error("can't resize capture file " + FileName + " " + FormatErrno(err));
+    }
+    auto map = mmap(nullptr, MaxFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (map == MAP_FAILED) {
+        auto err = errno;
+        CloseFile();
+        throw runtime_error("can't map capture file " + FileName + " " + FormatErrno(err));
+    }
+    Map = static_cast<uint8_t*>(map);
+    memcpy(Map, Signature, SignatureSize);
+    Size = SignatureSize;
+}
+
+void TFrameCaptureWriter::CloseFile()
+{
+    if (Map) {
+        munmap(Map, MaxFileSize);
+        Map = nullptr;
+    }
+    if (Fd >= 0) {
+        // Cut unused tail of preallocated file
+        if (ftruncate(Fd, Size) < 0) {}
+        close(Fd);
+        Fd = -1;
+    }
+}
+
+void TFrameCaptureWriter::Rotate()
+{
+    CloseFile();
+    auto oldFileName = FileName + ".1";
+    if (rename(FileName.c_str(), oldFileName.c_str()) < 0) {
+        throw runtime_error("can't rename capture file " + FileName + " " + FormatErrno(errno));
+    }
+    OpenFile();
+    auto now = chrono::steady_clock::now();
+    for (size_t i = 0; i < Ports.size(); ++i) {
+        Append(now,
+               TFrameCaptureRecordType::Port,
+               false,
+               i,
+               reinterpret_cast<const uint8_t*>(Ports[i].data()),
+               Ports[i].size());
+    }
+}
+
+void TFrameCaptureWriter::Append(TTimePoint                time,
+                                 TFrameCaptureRecordType   type,
+                                 bool                      truncated,
+                                 uint8_t                   port,
+                                 const uint8_t*            data,
+                                 size_t                    size)
+{
+    // File is closed after failed rotation
+    if (!Map) {
+        return;
+    }
+    if (size > UINT16_MAX) {
+        size = UINT16_MAX;
+        truncated = true;
+    }
+    if (Size + RecordHeaderSize + size > MaxFileSize) {
+        Rotate();
+    }
+    auto p = Map + Size;
+    PutUint(p, chrono::duration_cast<chrono::microseconds>(time.time_since_epoch()).count(), 8);
+    p[8] = static_cast<uint8_t>(type) | (truncated ? TruncatedFlag : 0);
+    p[9] = port;
+    PutUint(p + 10, size, 2);
+    memcpy(p + RecordHeaderSize, data, size);
+    Size += RecordHeaderSize + size;
+}
+
+uint8_t TFrameCaptureWriter::AddPort(const string& portId)
+{
+    if (Ports.size() > UINT8_MAX) {
+        throw runtime_error("too many ports in capture");
+    }
+    Ports.push_back(portId);
+    uint8_t index = Ports.size() - 1;
+    Append(chrono::steady_clock::now(),
+           TFrameCaptureRecordType::Port,
+           false,
+           index,
+           reinterpret_cast<const uint8_t*>(portId.data()),
+           portId.size());
+    return index;
+}
+
+void TFrameCaptureWriter::Write(uint8_t port, const TFrameTraceRecord& record)
+{
+    Append(record.Time,
+           static_cast<TFrameCaptureRecordType>(record.Direction),
+           record.Truncated,
+           port,
+           record.Data.data(),
+           record.Data.size());
+}
+
+vector<TFrameCaptureRecord> ReadFrameCapture(const string& fileName)
+{
+    ifstream f(fileName, ios::binary);
+    if (!f) {
+        throw runtime_error("can't open capture file " + fileName);
+    }
+    vector<uint8_t> data((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+    if (data.size() < SignatureSize || memcmp(data.data(), Signature, SignatureSize)) {
+        throw runtime_error(fileName + " is not a capture file");
+    }
+
+    vector<TFrameCaptureRecord> res;
+    size_t pos = SignatureSize;
+    while (pos + RecordHeaderSize <= data.size()) {
+        auto p = data.data() + pos;
+        auto time = GetUint(p, 8);
+        // Unused preallocated space of a file not closed properly
+        if (time == 0) {
+            return res;
+        }
+        TFrameCaptureRecord record;
+        record.Time = TTimePoint(chrono::microseconds(time));
+        uint8_t type = p[8] & ~TruncatedFlag;
+        if (type > static_cast<uint8_t>(TFrameCaptureRecordType::Port)) {
+            throw runtime_error("unknown record type in capture file " + fileName);
+        }
+        record.Type = static_cast<TFrameCaptureRecordType>(type);
+        record.Truncated = (p[8] & TruncatedFlag);
+        record.Port = p[9];
+        size_t size = GetUint(p + 10, 2);
+        pos += RecordHeaderSize;
+        if (pos + size > data.size()) {
+            throw runtime_error("truncated capture file " + fileName);
+        }
+        record.Data.assign(data.begin() + pos, data.begin() + pos + size);
+        pos += size;
+        res.push_back(move(record));
+    }
+    if (pos != data.size()) {
+        throw runtime_error("truncated capture file " + fileName);
+    }
+    return res;
+}
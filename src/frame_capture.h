@@ -0,0 +1,83 @@
+#pragma once
+
+#include "frame_trace.h"
+
+#include <string>
+#include <vector>
+
+/*
+ * Binary capture of port traffic.
+ *
+ * File starts with 8 bytes signature "WBSCAP02" followed by records.
+ * Every record has a header (little endian):
+ *   uint64_t time, us since steady clock epoch
+ *   uint8_t  type, TFrameCaptureRecordType, bit 7 is set if the frame is truncated
+ *   uint8_t  port index
+ *   uint16_t payload size
+ * and a payload. Frames are stored as a whole, only frames longer than 65535 bytes are truncated.
+ * Port records (type Port) bind port index to unique port id (see GetPortId),
+ * they are written at the beginning of every file, so each file can be read independently.
+ */
+
+enum class TFrameCaptureRecordType: uint8_t
+{
+    Write = static_cast<uint8_t>(TFrameDirection::Write),
+    Read  = static_cast<uint8_t>(TFrameDirection::Read),
+    Noise = static_cast<uint8_t>(TFrameDirection::Noise),
+    Port
+};
+
+struct TFrameCaptureRecord
+{
+    TTimePoint              Time;
+    TFrameCaptureRecordType Type;
+    uint8_t                 Port;
+    bool                    Truncated = false;
+    std::vector<uint8_t>    Data;
+};
+
+/**
+ * @brief Writes capture through memory mapped file.
+ *        When the file reaches maximum size, it is renamed to <file name>.1
+ *        (previous one is removed) and new file is started.
+ *        Not thread safe.
+ */
+class TFrameCaptureWriter
+{
+public:
+    TFrameCaptureWriter(const std::string& fileName, size_t maxFileSize = 4 * 1024 * 1024);
+    ~TFrameCaptureWriter();
+
+    TFrameCaptureWriter(const TFrameCaptureWriter&) = delete;
+    TFrameCaptureWriter& operator=(const TFrameCaptureWriter&) = delete;
+
+    //! Returns port index to be used in Write calls
+    uint8_t AddPort(const std::string& portId);
+
+    /**
+     * @brief Append record to capture file.
+     *        Throws std::runtime_error if the file can't be rotated, after that records are ignored.
+     */
+    void Write(uint8_t port, const TFrameTraceRecord& record);
+
+private:
+    void OpenFile();
+    void CloseFile();
+    void Rotate();
+    void Append(TTimePoint time, TFrameCaptureRecordType type, bool truncated, uint8_t port, const uint8_t* data, size_t size);
+
+    std::string              FileName;
+    size_t                   MaxFileSize;
+    int                      Fd;
+    uint8_t*                 Map;
+    size_t                   Size;
+    std::vector<std::string> Ports;
+};
+
+using PFrameCaptureWriter = std::shared_ptr<TFrameCaptureWriter>;
+
+/**
+ * @brief Read all records from capture file.
+ *        Throws std::runtime_error on errors.
+ */
+std::vector<TFrameCaptureRecord> ReadFrameCapture(const std::string& fileName);
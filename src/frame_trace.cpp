@@ -0,0 +1,122 @@
+#include "frame_trace.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string.h>
+
+using namespace std;
+
+const size_t TFrameTraceRecord::MAX_SIZE;
+const size_t TFrameTrace::CHUNK_SIZE;
+
+namespace
+{
+    //! Max number of bytes printed by FormatFrameTraceRecord
+    const size_t MAX_FORMATTED_SIZE = 256;
+}
+
+TFrameTrace::TFrameTrace(size_t capacity)
+    : Capacity(capacity),
+      Enabled(false),
+      Head(0),
+      Tail(0),
+      Dropped(0)
+{}
+
+void TFrameTrace::SetEnabled(bool enabled)
+{
+    // Ring takes CHUNK_SIZE bytes per slot, so it is allocated only for ports with enabled trace.
+    // Producer sees the ring after acquiring Enabled, consumer reads slots only after acquiring Head
+    if (enabled && Chunks.empty()) {
+        Chunks.resize(Capacity + 1); // one slot is always empty to distinguish full ring from empty one
+    }
+    Enabled.store(enabled, memory_order_release);
+}
+
+bool TFrameTrace::IsEnabled() const
+{
+    return Enabled.load(memory_order_acquire);
+}
+
+void TFrameTrace::Push(TFrameDirection direction, const uint8_t* buf, size_t size)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    bool truncated = (size > TFrameTraceRecord::MAX_SIZE);
+    if (truncated) {
+        size = TFrameTraceRecord::MAX_SIZE;
+    }
+    size_t chunkCount = max<size_t>(1, (size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    // Consumer only frees slots, so the number can't become smaller while the frame is written
+    auto head = Head.load(memory_order_relaxed);
+    auto freeSlots = (Tail.load(memory_order_acquire) + Chunks.size() - head - 1) % Chunks.size();
+    if (chunkCount > freeSlots) {
+        Dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    auto time = chrono::steady_clock::now();
+    for (size_t i = 0; i < chunkCount; ++i) {
+        auto& chunk = Chunks[(head + i) % Chunks.size()];
+        chunk.Time = time;
+        chunk.Direction = direction;
+        chunk.Truncated = truncated;
+        chunk.FrameSize = size;
+        chunk.Size = min(size - i * CHUNK_SIZE, CHUNK_SIZE);
+        memcpy(chunk.Data, buf + i * CHUNK_SIZE, chunk.Size);
+    }
+
+    // The frame becomes visible to consumer as a whole
+    Head.store((head + chunkCount) % Chunks.size(), memory_order_release);
+}
+
+bool TFrameTrace::Pop(TFrameTraceRecord& record)
+{
+    auto tail = Tail.load(memory_order_relaxed);
+    if (tail == Head.load(memory_order_acquire)) {
+        return false;
+    }
+
+    const auto& first = Chunks[tail];
+    record.Time = first.Time;
+    record.Direction = first.Direction;
+    record.Truncated = first.Truncated;
+    record.Data.clear();
+    size_t chunkCount = max<size_t>(1, (first.FrameSize + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const auto& chunk = Chunks[(tail + i) % Chunks.size()];
+        record.Data.insert(record.Data.end(), chunk.Data, chunk.Data + chunk.Size);
+    }
+
+    Tail.store((tail + chunkCount) % Chunks.size(), memory_order_release);
+    return true;
+}
+
+size_t TFrameTrace::TakeDropped()
+{
+    return Dropped.exchange(0, memory_order_relaxed);
+}
+
+string FormatFrameTraceRecord(const TFrameTraceRecord& record)
+{
+    stringstream ss;
+    ss << chrono::duration_cast<chrono::microseconds>(record.Time.time_since_epoch()).count() << ": ";
+    switch (record.Direction) {
+        case TFrameDirection::Write: ss << "Write:"; break;
+        case TFrameDirection::Read:  ss << "Read:"; break;
+        case TFrameDirection::Noise: ss << "read noise:"; break;
+    }
+    ss << hex << setfill('0');
+    auto size = min(record.Data.size(), MAX_FORMATTED_SIZE);
+    for (size_t i = 0; i < size; ++i) {
+        ss << " " << setw(2) << int(record.Data[i]);
+    }
+    if (size < record.Data.size() || record.Truncated) {
+        ss << " ... (" << dec << record.Data.size() << (record.Truncated ? "+" : "") << " bytes)";
+    }
+    return ss.str();
+}
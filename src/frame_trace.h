@@ -0,0 +1,81 @@
+#pragma once
+
+#include "definitions.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class TFrameDirection: uint8_t
+{
+    Write,
+    Read,
+    Noise
+};
+
+struct TFrameTraceRecord
+{
+    //! Max frame size, longer frames are truncated
+    static const size_t MAX_SIZE = UINT16_MAX;
+
+    TTimePoint           Time;
+    TFrameDirection      Direction;
+    bool                 Truncated = false;
+    std::vector<uint8_t> Data;
+};
+
+/**
+ * @brief Binary trace of port traffic.
+ *        Frames are copied into a fixed size lock-free ring buffer with timestamps and direction,
+ *        formatting is done by a consumer in another thread, so tracing doesn't affect bus timing.
+ *        A frame longer than a ring slot occupies several consecutive slots.
+ *        Single producer (port thread) and single consumer are supported.
+ *        If the ring doesn't have enough free slots for a frame, the frame is dropped and counted.
+ */
+class TFrameTrace
+{
+public:
+    //! Size of a ring slot
+    static const size_t CHUNK_SIZE = 256;
+
+    //! capacity is a number of ring slots. The ring is allocated when trace is enabled first time
+    explicit TFrameTrace(size_t capacity = 1024);
+
+    //! Must not be called concurrently with itself. Disabling keeps the ring allocated
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const;
+
+    //! Called by producer. Does nothing if trace is disabled
+    void Push(TFrameDirection direction, const uint8_t* buf, size_t size);
+
+    //! Called by consumer. Returns false if there are no records
+    bool Pop(TFrameTraceRecord& record);
+
+    //! Returns number of dropped records since last call
+    size_t TakeDropped();
+
+private:
+    struct TChunk
+    {
+        TTimePoint      Time;
+        TFrameDirection Direction;
+        bool            Truncated;
+        uint16_t        FrameSize;
+        uint16_t        Size;
+        uint8_t         Data[CHUNK_SIZE];
+    };
+
+    size_t                         Capacity;
+    std::vector<TChunk>            Chunks;
+    std::atomic<bool>              Enabled;
+    std::atomic<size_t>            Head; // Next slot to write, modified by producer only
+    std::atomic<size_t>            Tail; // Next slot to read, modified by consumer only
+    std::atomic<size_t>            Dropped;
+};
+
+using PFrameTrace = std::shared_ptr<TFrameTrace>;
+
+//! Formats record as "<time us>: <direction>: XX XX ...", long frames are shortened
+std::string FormatFrameTraceRecord(const TFrameTraceRecord& record);
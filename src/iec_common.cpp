@@ -11,6 +11,34 @@ namespace IEC
 {
     const size_t RESPONSE_BUF_LEN = 1000;
 
+    //! Whole data set of a meter can be much longer than response to a single request
+    const size_t DATA_READOUT_BUF_LEN = 16384;
+
+    //! After that number of consecutive malformed or missing data readouts only R1 requests are used
+    const size_t MAX_DATA_READOUT_ERRORS = 3;
+
+    //! Baud rate identification for 9600 baud in mode C. The session is started at this rate
+    const char DEFAULT_BAUD_RATE_ID = '5';
+
+    //! Mode C data readout and programming mode in option select message
+    const char DATA_READOUT_MODE = '0';
+    const char PROGRAMMING_MODE  = '1';
+
+    //! Returns baud rate for mode C baud rate identification character or 0 if the character is unknown
+    int GetModeCBaudRate(char baudRateId)
+    {
+        switch (baudRateId) {
+            case '0': return 300;
+            case '1': return 600;
+            case '2': return 1200;
+            case '3': return 2400;
+            case '4': return 4800;
+            case '5': return 9600;
+            case '6': return 19200;
+            default:  return 0;
+        }
+    }
+
     TPort::TFrameCompletePred GetCRLFPacketPred()
     {
         return [](uint8_t* b, int s) { return s >= 2 && b[s - 1] == '\n' && b[s - 2] == '\r'; };
@@ -203,38 +231,82 @@ bool TIEC61107Protocol::SupportsBroadcast() const
 }
 
 TIEC61107ModeCDevice::TIEC61107ModeCDevice(PDeviceConfig device_config, PPort port, PProtocol protocol, const std::string& logPrefix, IEC::TCrcFn crcFn)
-    : TIEC61107Device(device_config, port, protocol), CrcFn(crcFn), LogPrefix(logPrefix)
+    : TIEC61107Device(device_config, port, protocol),
+      CrcFn(crcFn),
+      LogPrefix(logPrefix),
+      ProgModeIsOn(false),
+      DataReadoutEnabled(false),
+      DataReadoutIsDone(false),
+      DataReadoutErrorCount(0),
+      SessionTimeout(IEC::DEFAULT_SESSION_TIMEOUT),
+      BaudRateSwitching(false)
 {}
 
+void TIEC61107ModeCDevice::SetBaudRateSwitching(bool enabled)
+{
+    BaudRateSwitching = enabled;
+}
+
+void TIEC61107ModeCDevice::RestoreBaudRate()
+{
+    if (BaudRateSwitching) {
+        Port()->SetBaudRate(0);
+    }
+}
+
+void TIEC61107ModeCDevice::SetDataReadout(bool enabled)
+{
+    DataReadoutEnabled = enabled;
+}
+
+void TIEC61107ModeCDevice::SetSessionTimeout(const std::chrono::milliseconds& timeout)
+{
+    SessionTimeout = timeout;
+}
+
+bool TIEC61107ModeCDevice::IsSessionExpired() const
+{
+    return SessionTimeout.count() > 0 && Port()->CurrentTime() - LastExchangeTime >= SessionTimeout;
+}
+
 void TIEC61107ModeCDevice::Prepare()
 {
     TIEC61107Device::Prepare();
-    uint8_t buf[IEC::RESPONSE_BUF_LEN] = {};
+    // Data readout failures of a disconnected meter say nothing about readout support, try it again after reconnection
+    if (GetIsDisconnected()) {
+        DataReadoutErrorCount = 0;
+    }
+    // Data readout starts its own session
+    if (!IsDataReadoutActive()) {
+        StartProgModeSession();
+    }
+}
+
+bool TIEC61107ModeCDevice::IsDataReadoutActive() const
+{
+    return DataReadoutEnabled && DataReadoutErrorCount < IEC::MAX_DATA_READOUT_ERRORS;
+}
+
+void TIEC61107ModeCDevice::StartProgModeSession()
+{
+    ProgModeIsOn = false;
     size_t retryCount = 5;
     bool sessionIsOpen;
     while (true) {
         try {
             sessionIsOpen = false;
             Port()->SkipNoise();
-
-            // Send session start request
-            WriteBytes("/?" + SlaveId + "!\r\n");
-            // Pass identification response
-            IEC::ReadFrame(*Port(),
-                           buf,
-                           sizeof(buf),
-                           DeviceConfig()->ResponseTimeout,
-                           DeviceConfig()->FrameTimeout,
-                           IEC::GetCRLFPacketPred(), 
-                           LogPrefix);
+            auto baudRateId = SendSessionStartRequest();
             sessionIsOpen = true;
-            SwitchToProgMode();
+            SwitchToProgMode(baudRateId);
             SendPassword();
+            ProgModeIsOn = true;
             return;
         } catch (const TSerialDeviceTransientErrorException& e) {
             Debug.Log() << LogPrefix << "Session start error: " << e.what() << " [slave_id is " << ToString() + "]";
             if (sessionIsOpen) {
                 SendEndSession();
+                RestoreBaudRate();
             }
             --retryCount;
             if (retryCount == 0) {
@@ -247,12 +319,46 @@ void TIEC61107ModeCDevice::Prepare()
 void TIEC61107ModeCDevice::EndSession()
 {
     SendEndSession();
+    ProgModeIsOn = false;
+    RestoreBaudRate();
     TIEC61107Device::EndSession();
 }
 
+char TIEC61107ModeCDevice::SendSessionStartRequest()
+{
+    // The session always starts at initial baud rate
+    bool canSwitchBaudRate = BaudRateSwitching && Port()->SetBaudRate(0);
+    uint8_t buf[IEC::RESPONSE_BUF_LEN] = {};
+    WriteBytes("/?" + SlaveId + "!\r\n");
+    auto len = IEC::ReadFrame(*Port(),
+                              buf,
+                              sizeof(buf),
+                              DeviceConfig()->ResponseTimeout,
+                              DeviceConfig()->FrameTimeout,
+                              IEC::GetCRLFPacketPred(),
+                              LogPrefix);
+
+    // Identification message: /XXXZ<identification><CR><LF>, Z is the maximum baud rate of the meter
+    if (canSwitchBaudRate && len > 4 && IEC::GetModeCBaudRate(buf[4]) != 0) {
+        return buf[4];
+    }
+    return IEC::DEFAULT_BAUD_RATE_ID;
+}
+
+void TIEC61107ModeCDevice::SendOptionSelect(char baudRateId, char mode)
+{
+    WriteBytes(std::string("\006" "0") + baudRateId + mode + "\r\n");
+    // The meter answers at the new baud rate, the port switches after acknowledgement is transmitted
+    if (baudRateId != IEC::DEFAULT_BAUD_RATE_ID) {
+        Port()->SetBaudRate(IEC::GetModeCBaudRate(baudRateId));
+    }
+}
+
 void TIEC61107ModeCDevice::EndPollCycle()
 {
     CmdResultCache.clear();
+    DataReadoutCache.clear();
+    DataReadoutIsDone = false;
     TSerialDevice::EndPollCycle();
 }
 
@@ -260,7 +366,92 @@ uint64_t TIEC61107ModeCDevice::ReadRegister(PRegister reg)
 {
     Port()->SkipNoise();
     Port()->CheckPortOpen();
-    return GetRegisterValue(*reg, GetCachedResponse(GetParameterRequest(*reg)));
+    return GetRegisterValue(*reg, GetResponse(*reg));
+}
+
+std::string TIEC61107ModeCDevice::GetDataReadoutAddress(const TRegister& reg) const
+{
+    auto paramRequest = GetParameterRequest(reg);
+    auto pos = paramRequest.find('(');
+    // Parameters with arguments are not present in data readout
+    if (pos != std::string::npos && paramRequest.compare(pos, std::string::npos, "()") != 0) {
+        return std::string();
+    }
+    return paramRequest.substr(0, pos);
+}
+
+std::string TIEC61107ModeCDevice::GetResponse(const TRegister& reg)
+{
+    if (IsDataReadoutActive()) {
+        if (!DataReadoutIsDone) {
+            DataReadoutIsDone = true;
+            ReadDataReadout();
+        }
+        auto it = DataReadoutCache.find(GetDataReadoutAddress(reg));
+        if (it != DataReadoutCache.end()) {
+            return it->second;
+        }
+    }
+    return GetCachedResponse(GetParameterRequest(reg));
+}
+
+void TIEC61107ModeCDevice::ReadDataReadout()
+{
+    // Data readout is available only from the start of a session, so current one must be closed.
+    // The meter closes the session after readout by itself
+    if (ProgModeIsOn) {
+        SendEndSession();
+        ProgModeIsOn = false;
+    }
+    bool sessionIsOpen = false;
+    try {
+        auto baudRateId = SendSessionStartRequest();
+        sessionIsOpen = true;
+        SendOptionSelect(baudRateId, IEC::DATA_READOUT_MODE);
+        std::vector<uint8_t> resp(IEC::DATA_READOUT_BUF_LEN);
+        auto len = ReadFrameProgMode(resp.data(), resp.size(), IEC::STX);
+        // The meter returns to initial baud rate after readout
+        RestoreBaudRate();
+        // <STX>DATA!<CR><LF><ETX>BCC
+        if (len < 3 || resp[0] != IEC::STX || resp[len - 2] != IEC::ETX) {
+            throw TSerialDeviceTransientErrorException("malformed data readout");
+        }
+
+        // Every line is an address followed by values in brackets.
+        // A list of values can be split into several lines, next lines start from '('.
+        // Values are stored in the same form as in R1 responses
+        std::string data(reinterpret_cast<const char*>(resp.data()) + 1, len - 3);
+        std::string address;
+        for (const auto& line: WBMQTT::StringSplit(data, "\r\n")) {
+            if (line.empty() || line == "!") {
+                continue;
+            }
+            if (line.front() != '(') {
+                auto pos = line.find('(');
+                if (pos == std::string::npos) {
+                    address.clear();
+                    continue;
+                }
+                address = line.substr(0, pos);
+                DataReadoutCache[address] = line.substr(pos) + "\r\n";
+            } else if (!address.empty()) {
+                DataReadoutCache[address] += line + "\r\n";
+            }
+        }
+        DataReadoutErrorCount = 0;
+    } catch (const TSerialDeviceTransientErrorException& e) {
+        // The meter answers identification request, but doesn't send proper data readout
+        if (sessionIsOpen) {
+            ++DataReadoutErrorCount;
+        }
+        Warn.Log() << LogPrefix << "Data readout failed: " << e.what() << " [slave_id is " << ToString() + "]";
+        if (!IsDataReadoutActive()) {
+            Warn.Log() << LogPrefix << "Data readout is disabled, parameters will be read one by one [slave_id is " << ToString() + "]";
+        }
+        // The meter may still wait for a request in the session
+        SendEndSession();
+        RestoreBaudRate();
+    }
 }
 
 void TIEC61107ModeCDevice::WriteRegister(PRegister, uint64_t)
@@ -275,10 +466,29 @@ std::string TIEC61107ModeCDevice::GetCachedResponse(const std::string& paramRequ
         return it->second;
     }
 
+    // The session is kept open while the meter's inactivity timer is running.
+    // The meter may not have closed expired session yet, so it is closed explicitly before reopening
+    if (ProgModeIsOn && IsSessionExpired()) {
+        Debug.Log() << LogPrefix << "Session is expired, reopening [slave_id is " << ToString() + "]";
+        SendEndSession();
+        ProgModeIsOn = false;
+    }
+    if (!ProgModeIsOn) {
+        StartProgModeSession();
+    }
+
     WriteBytes(IEC::MakeRequest("R1", paramRequest, CrcFn));
 
     uint8_t resp[IEC::RESPONSE_BUF_LEN] = {};
-    auto len = ReadFrameProgMode(resp, sizeof(resp), IEC::STX);
+    size_t len;
+    try {
+        len = ReadFrameProgMode(resp, sizeof(resp), IEC::STX);
+    } catch (const TSerialDeviceTransientErrorException&) {
+        // The meter could drop the session, so it will be reopened before next request
+        SendEndSession();
+        ProgModeIsOn = false;
+        throw;
+    }
     // Proper response (inc. error) must start with STX, and end with ETX
     if ((resp[0] != IEC::STX) || (resp[len-2] != IEC::ETX)) {
         throw TSerialDeviceTransientErrorException("malformed response");
@@ -308,12 +518,12 @@ std::string TIEC61107ModeCDevice::GetCachedResponse(const std::string& paramRequ
     throw TSerialDeviceTransientErrorException(presp);
 }
 
-void TIEC61107ModeCDevice::SwitchToProgMode()
+void TIEC61107ModeCDevice::SwitchToProgMode(char baudRateId)
 {
     uint8_t buf[IEC::RESPONSE_BUF_LEN] = {};
 
-    // We expect mode C protocol and 9600 baudrate. Send ACK for entering into progamming mode
-    WriteBytes("\006" "051\r\n");
+    // We expect mode C protocol. Send ACK for entering into progamming mode
+    SendOptionSelect(baudRateId, IEC::PROGRAMMING_MODE);
     ReadFrameProgMode(buf, sizeof(buf), IEC::SOH);
 
     // <SOH>P0<STX>(IDENTIFIER)<ETX>CRC
@@ -363,6 +573,7 @@ size_t TIEC61107ModeCDevice::ReadFrameProgMode(uint8_t* buf, size_t size, uint8_
                               LogPrefix);
 
     if ((len == 1) && (buf[0] == IEC::ACK || buf[0] == IEC::NAK)) {
+        LastExchangeTime = Port()->CurrentTime();
         return len;
     }
     if (len < 2) {
@@ -372,6 +583,7 @@ size_t TIEC61107ModeCDevice::ReadFrameProgMode(uint8_t* buf, size_t size, uint8_
     if (buf[len - 1] != checksum) {
         throw TSerialDeviceTransientErrorException("invalid response checksum (" + std::to_string(buf[len - 1]) + " != " + std::to_string(checksum) + ")");
     }
+    LastExchangeTime = Port()->CurrentTime();
     //replace crc with null byte to make it C string
     buf[len - 1] = '\000';
     return len;
@@ -5,6 +5,7 @@
 #include <functional>
 
 #include "serial_device.h"
+#include "serial_config.h"
 
 namespace IEC
 {
@@ -15,6 +16,9 @@ namespace IEC
     const uint8_t STX = 0x02;
     const uint8_t EOT = 0x04;
 
+    //! IEC 62056-21 inactivity time-out of programming mode is from 60 to 120 seconds
+    const std::chrono::milliseconds DEFAULT_SESSION_TIMEOUT(60000);
+
     typedef std::function<uint8_t(const uint8_t* buf, size_t size)> TCrcFn;
 
     void CheckStripEvenParity(uint8_t* buf, size_t nread);
@@ -69,6 +73,8 @@ public:
 /**
  *  Base class for devices with IEC 61107 mode C protocol.
  *  Implements session management logic and read requests for single parameters.
+ *  Optionally all parameters are read by single data readout once per poll cycle.
+ *  Parameters missing in the readout are read by R1 requests.
  */
 class TIEC61107ModeCDevice: public TIEC61107Device
 {
@@ -81,6 +87,14 @@ public:
     void EndSession() override;
     void Prepare() override;
 
+    void SetDataReadout(bool enabled);
+
+    //! Programming mode session is reopened if there were no exchanges for the timeout. 0 - never reopen
+    void SetSessionTimeout(const std::chrono::milliseconds& timeout);
+
+    //! Switch port to the maximum baud rate from meter's identification message after session start
+    void SetBaudRateSwitching(bool enabled);
+
 protected:
     /**
      * @brief Get string with parameter request for R1 command
@@ -91,16 +105,77 @@ protected:
     virtual std::string GetParameterRequest(const TRegister& reg) const = 0;
     virtual uint64_t    GetRegisterValue(const TRegister& reg, const std::string& value) = 0;
 
+    /**
+     * @brief Get address of parameter in data readout.
+     *        Default implementation returns name of parameter from R1 request without arguments.
+     *        Empty string means that the parameter can't be found in data readout.
+     * Examples:
+     *    ETOPE
+     *    1.8.0
+     */
+    virtual std::string GetDataReadoutAddress(const TRegister& reg) const;
+
 private:
     IEC::TCrcFn                                  CrcFn;
     std::string                                  LogPrefix;
     std::unordered_map<std::string, std::string> CmdResultCache;
-
+    bool                                         ProgModeIsOn;
+    bool                                         DataReadoutEnabled;
+    bool                                         DataReadoutIsDone;
+    size_t                                       DataReadoutErrorCount;
+    std::unordered_map<std::string, std::string> DataReadoutCache;
+    std::chrono::milliseconds                    SessionTimeout;
+    TTimePoint                                   LastExchangeTime;
+    bool                                         BaudRateSwitching;
+
+    bool IsDataReadoutActive() const;
+    bool IsSessionExpired() const;
+    std::string GetResponse(const TRegister& reg);
     std::string GetCachedResponse(const std::string& paramAddress);
-    void SwitchToProgMode();
+    void StartProgModeSession();
+    void ReadDataReadout();
+
+    //! Sends session start request and returns baud rate identification for option select message
+    char SendSessionStartRequest();
+    void SendOptionSelect(char baudRateId, char mode);
+    void RestoreBaudRate();
+    void SwitchToProgMode(char baudRateId);
     void SendPassword();
     void SendEndSession();
     size_t ReadFrameProgMode(uint8_t* buffer, size_t size, uint8_t startByte);
     void WriteBytes(const std::vector<uint8_t>& data);
     void WriteBytes(const std::string& str);
 };
+
+/**
+ *  Factory for IEC 61107 mode C devices.
+ *  Sets common options of mode C devices from config.
+ */
+template<class Dev> class TIEC61107ModeCDeviceFactory: public IDeviceFactory
+{
+public:
+    TIEC61107ModeCDeviceFactory(std::unique_ptr<IRegisterAddressFactory> registerAddressFactory,
+                                const std::string&                       commonDeviceSchemaRef,
+                                const std::string&                       customChannelSchemaRef = std::string())
+        : IDeviceFactory(std::move(registerAddressFactory), commonDeviceSchemaRef, customChannelSchemaRef)
+    {}
+
+    PSerialDevice CreateDevice(const Json::Value& data,
+                               PDeviceConfig      deviceConfig,
+                               PPort              port,
+                               PProtocol          protocol) const override
+    {
+        auto dev = std::make_shared<Dev>(deviceConfig, port, protocol);
+        bool dataReadout = false;
+        WBMQTT::JSON::Get(data, "iec_data_readout", dataReadout);
+        dev->SetDataReadout(dataReadout);
+        auto sessionTimeout = IEC::DEFAULT_SESSION_TIMEOUT;
+        WBMQTT::JSON::Get(data, "iec_session_timeout_ms", sessionTimeout);
+        dev->SetSessionTimeout(sessionTimeout);
+        bool baudRateSwitching = false;
+        WBMQTT::JSON::Get(data, "iec_baud_rate_switching", baudRateSwitching);
+        dev->SetBaudRateSwitching(baudRateSwitching);
+        dev->InitSetupItems();
+        return dev;
+    }
+};
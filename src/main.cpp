@@ -16,6 +16,7 @@
 
 #include "device_template_generator.h"
 #include "serial_port.h"
+#include "replay_port.h"
 
 #define STR(x) #x
 #define XSTR(x) STR(x)
@@ -69,7 +70,10 @@ namespace
              << "  -g                 Generate JSON Schema for wb-mqtt-confed" << endl
              << "  -j                 Make JSON for wb-mqtt-confed from /etc/wb-mqtt-serial.conf" << endl
              << "  -J                 Make /etc/wb-mqtt-serial.conf from wb-mqtt-confed output" << endl
-             << "  -G       options   Generate device template. Type \"-G help\" for options description" << endl;
+             << "  -G       options   Generate device template. Type \"-G help\" for options description" << endl
+             << "  -C       file      write binary capture of ports traffic to file" << endl
+             << "  -R       file      replay capture file instead of using real ports" << endl
+             << "  -S       speed     replay speed multiplier (default: 1)" << endl;
     }
 
     /**
@@ -184,14 +188,22 @@ namespace
         exit(2);
     }
 
+    struct TCaptureOptions
+    {
+        string CaptureFile;
+        string ReplayFile;
+        double ReplaySpeed = 1;
+    };
+
     void ParseCommadLine(int                           argc,
                          char*                         argv[],
                          WBMQTT::TMosquittoMqttConfig& mqttConfig,
-                         string&                       customConfig)
+                         string&                       customConfig,
+                         TCaptureOptions&              captureOptions)
     {
         int c;
 
-        while ((c = getopt(argc, argv, "d:c:h:H:p:u:P:T:jJgG:")) != -1) {
+        while ((c = getopt(argc, argv, "d:c:h:H:p:u:P:T:jJgG:C:R:S:")) != -1) {
             switch (c) {
             case 'd':
                 SetDebugLevel(optarg);
@@ -227,6 +239,24 @@ namespace
             case 'G':
                 GenerateDeviceTemplate(APP_NAME, USER_TEMPLATES_DIR, optarg);
                 exit(0);
+            case 'C':
+                captureOptions.CaptureFile = optarg;
+                break;
+            case 'R':
+                captureOptions.ReplayFile = optarg;
+                break;
+            case 'S':
+                try {
+                    captureOptions.ReplaySpeed = stod(optarg);
+                } catch (...) {
+                    captureOptions.ReplaySpeed = 0;
+                }
+                if (captureOptions.ReplaySpeed <= 0) {
+                    cout << "Invalid -S parameter value " << optarg << endl;
+                    PrintUsage();
+                    exit(2);
+                }
+                break;
             case '?':
             default:
                 PrintStartupInfo();
@@ -252,7 +282,8 @@ int main(int argc, char *argv[])
     WBMQTT::SignalHandling::OnSignals({SIGINT, SIGTERM}, [&]{ WBMQTT::SignalHandling::Stop(); });
     WBMQTT::SetThreadName(APP_NAME);
 
-    ParseCommadLine(argc, argv, mqttConfig, configFilename);
+    TCaptureOptions captureOptions;
+    ParseCommadLine(argc, argv, mqttConfig, configFilename, captureOptions);
 
     PHandlerConfig handlerConfig;
     TSerialDeviceFactory deviceFactory;
@@ -268,10 +299,15 @@ int main(int argc, char *argv[])
         } catch (const TConfigParserException& e) {        // Pass exception if user templates dir doesn't exist
         }
 
+        TPortFactoryFn portFactory = DefaultPortFactory;
+        if (!captureOptions.ReplayFile.empty()) {
+            portFactory = MakeReplayPortFactory(captureOptions.ReplayFile, captureOptions.ReplaySpeed);
+        }
         handlerConfig = LoadConfig(configFilename,
                                   deviceFactory,
                                   configSchema,
-                                  templates);
+                                  templates,
+                                  portFactory);
     } catch (const exception& e) {
         LOG(Error) << e.what();
         return 0;
@@ -304,7 +340,12 @@ int main(int argc, char *argv[])
 
         driver->WaitForReady();
 
-        auto serialDriver = make_shared<TMQTTSerialDriver>(driver, handlerConfig);
+        PFrameCaptureWriter frameCapture;
+        if (!captureOptions.CaptureFile.empty()) {
+            frameCapture = make_shared<TFrameCaptureWriter>(captureOptions.CaptureFile);
+        }
+
+        auto serialDriver = make_shared<TMQTTSerialDriver>(driver, handlerConfig, frameCapture);
 
         serialDriver->Start();
 
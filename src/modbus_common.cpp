@@ -58,7 +58,7 @@ namespace Modbus    // modbus protocol declarations
     class TModbusRegisterRange: public TRegisterRange
     {
     public:
-        TModbusRegisterRange(const std::list<PRegister>& regs, bool hasHoles);
+        TModbusRegisterRange(const TRegisterSpan& regs, bool hasHoles);
         ~TModbusRegisterRange();
         EStatus GetStatus() const override;
         void  SetStatus(EStatus status);
@@ -121,8 +121,8 @@ namespace   // general utilities
     // returns true if multi write needs to be done
     inline bool IsPacking(const TRegister& reg)
     {
-        return (reg.Type == Modbus::REG_HOLDING_MULTI) ||
-              ((reg.Type == Modbus::REG_HOLDING) && (reg.Get16BitWidth() > 1));
+        return (reg.GetConfig()->Type == Modbus::REG_HOLDING_MULTI) ||
+              ((reg.GetConfig()->Type == Modbus::REG_HOLDING) && (reg.GetConfig()->Get16BitWidth() > 1));
     }
 
     inline bool IsPacking(Modbus::TModbusRegisterRange& range)
@@ -150,7 +150,7 @@ namespace Modbus    // modbus protocol common utilities
         {}
     };
 
-    TModbusRegisterRange::TModbusRegisterRange(const std::list<PRegister>& regs, bool hasHoles)
+    TModbusRegisterRange::TModbusRegisterRange(const TRegisterSpan& regs, bool hasHoles)
         : TRegisterRange(regs)
         , HasHolesFlg(hasHoles)
     {
@@ -159,21 +159,21 @@ namespace Modbus    // modbus protocol common utilities
 
         if (IsSingleBitType(Type())) {
             for (auto reg: RegisterList()) {
-                if (reg->Get16BitWidth() != 1)
+                if (reg->GetConfig()->Get16BitWidth() != 1)
                     throw TSerialDeviceException(
                         "width other than 1 is not currently supported for reg type" +
-                        reg->TypeName);
+                        reg->GetConfig()->TypeName);
             }
         }
 
         auto it = regs.begin();
-        Start = GetUint32RegisterAddress((*it)->GetAddress());
-        int end = Start + (*it)->Get16BitWidth();
+        Start = GetUint32RegisterAddress((*it)->GetConfig()->GetAddress());
+        int end = Start + (*it)->GetConfig()->Get16BitWidth();
         while (++it != regs.end()) {
-            if ((*it)->Type != Type())
+            if ((*it)->GetConfig()->Type != Type())
                 throw std::runtime_error("registers of different type in the same range");
-            auto addr = GetUint32RegisterAddress((*it)->GetAddress());
-            int new_end = addr + (*it)->Get16BitWidth();
+            auto addr = GetUint32RegisterAddress((*it)->GetConfig()->GetAddress());
+            int new_end = addr + (*it)->GetConfig()->Get16BitWidth();
             if (new_end > end)
                 end = new_end;
         }
@@ -311,7 +311,7 @@ namespace Modbus    // modbus protocol common utilities
 
     inline uint8_t GetFunction(const TRegister& reg, OperationType op)
     {
-        return GetFunctionImpl(reg.Type, op, reg.TypeName, IsPacking(reg));
+        return GetFunctionImpl(reg.GetConfig()->Type, op, reg.GetConfig()->TypeName, IsPacking(reg));
     }
 
     inline uint8_t GetFunction(TModbusRegisterRange& range, OperationType op)
@@ -354,16 +354,16 @@ namespace Modbus    // modbus protocol common utilities
     // returns count of modbus registers needed to represent TRegister
     uint16_t GetQuantity(TRegister& reg)
     {
-        int w = reg.Get16BitWidth();
+        int w = reg.GetConfig()->Get16BitWidth();
 
-        if (IsSingleBitType(reg.Type)) {
+        if (IsSingleBitType(reg.GetConfig()->Type)) {
             if (w != 1) {
-                throw TSerialDeviceException("width other than 1 is not currently supported for reg type" + reg.TypeName);
+                throw TSerialDeviceException("width other than 1 is not currently supported for reg type" + reg.GetConfig()->TypeName);
             }
             return 1;
         } else {
-            if (w > 4 && reg.BitOffset == 0) {
-                throw TSerialDeviceException("can't pack more than 4 " + reg.TypeName + "s into a single value");
+            if (w > 4 && reg.GetConfig()->BitOffset == 0) {
+                throw TSerialDeviceException("can't pack more than 4 " + reg.GetConfig()->TypeName + "s into a single value");
             }
             return w;
         }
@@ -389,13 +389,13 @@ namespace Modbus    // modbus protocol common utilities
     // returns number of bytes needed to hold request
     size_t InferWriteRequestPDUSize(const TRegister& reg)
     {
-       return IsPacking(reg) ? 6 + reg.Get16BitWidth() * 2 : 5;
+       return IsPacking(reg) ? 6 + reg.GetConfig()->Get16BitWidth() * 2 : 5;
     }
 
     // returns number of requests needed to write register
     size_t InferWriteRequestsCount(const TRegister& reg)
     {
-       return IsPacking(reg) ? 1 : reg.Get16BitWidth();
+       return IsPacking(reg) ? 1 : reg.GetConfig()->Get16BitWidth();
     }
 
     // returns number of bytes needed to hold response
@@ -426,7 +426,7 @@ namespace Modbus    // modbus protocol common utilities
     void ComposeReadRequestPDU(uint8_t* pdu, TRegister& reg, int shift)
     {
         pdu[0] = GetFunction(reg, OperationType::OP_READ);
-        auto addr = GetUint32RegisterAddress(reg.GetAddress());
+        auto addr = GetUint32RegisterAddress(reg.GetConfig()->GetAddress());
         WriteAs2Bytes(pdu + 1, addr + shift);
         WriteAs2Bytes(pdu + 3, GetQuantity(reg));
     }
@@ -446,24 +446,24 @@ namespace Modbus    // modbus protocol common utilities
 
         pdu[0] = GetFunction(reg, OperationType::OP_WRITE);
 
-        auto addr = GetUint32RegisterAddress(reg.GetAddress());
+        auto addr = GetUint32RegisterAddress(reg.GetConfig()->GetAddress());
         auto baseAddress = addr + shift;
-        const auto bitWidth = reg.GetBitWidth();
+        const auto bitWidth = reg.GetConfig()->GetBitWidth();
 
         auto bitsToAllocate = bitWidth;
 
         TAddress address;
 
-        address.Type = reg.Type;
+        address.Type = reg.GetConfig()->Type;
 
         WriteAs2Bytes(pdu + 1, baseAddress);
-        WriteAs2Bytes(pdu + 3, reg.Get16BitWidth());
+        WriteAs2Bytes(pdu + 3, reg.GetConfig()->Get16BitWidth());
 
-        pdu[5] = reg.Get16BitWidth() * 2;
+        pdu[5] = reg.GetConfig()->Get16BitWidth() * 2;
 
         uint8_t bitPos = 0, bitPosEnd = bitWidth;
 
-        for (int i = 0; i < reg.Get16BitWidth(); ++i) {
+        for (int i = 0; i < reg.GetConfig()->Get16BitWidth(); ++i) {
             address.Address = baseAddress + i;
 
             uint16_t cachedValue;
@@ -473,7 +473,7 @@ namespace Modbus    // modbus protocol common utilities
                 cachedValue = value & 0xffff;
             }
 
-            auto localBitOffset = std::max(reg.BitOffset - bitPos, 0);
+            auto localBitOffset = std::max(reg.GetConfig()->BitOffset - bitPos, 0);
 
             auto bitCount = std::min(uint8_t(16 - localBitOffset), bitsToAllocate);
 
@@ -498,16 +498,16 @@ namespace Modbus    // modbus protocol common utilities
         auto & tmpCache = reg.Device()->ModbusTmpCache;
         const auto & cache = reg.Device()->ModbusCache;
 
-        if (reg.Type == REG_COIL) {
+        if (reg.GetConfig()->Type == REG_COIL) {
             value = value ? uint16_t(0xFF) << 8: 0x00;
         }
 
-        auto bitWidth = reg.GetBitWidth();
+        auto bitWidth = reg.GetConfig()->GetBitWidth();
 
         TAddress address;
 
-        address.Type = reg.Type;
-        auto addr = GetUint32RegisterAddress(reg.GetAddress());
+        address.Type = reg.GetConfig()->Type;
+        auto addr = GetUint32RegisterAddress(reg.GetConfig()->GetAddress());
         address.Address = addr + shift + wordIndex;
 
         uint16_t cachedValue;
@@ -518,7 +518,7 @@ namespace Modbus    // modbus protocol common utilities
         }
 
 
-        auto localBitOffset = std::max(reg.BitOffset - wordIndex * 16, 0);
+        auto localBitOffset = std::max(reg.GetConfig()->BitOffset - wordIndex * 16, 0);
 
         auto bitCount = std::min(uint8_t(16 - localBitOffset), bitWidth);
 
@@ -569,7 +569,7 @@ namespace Modbus    // modbus protocol common utilities
             }
 
             for (auto reg: range.RegisterList()) {
-                auto addr = GetUint32RegisterAddress(reg->GetAddress());
+                auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
                 reg->SetValue(range.GetBits()[addr - range.GetStart()]);
             }
             return;
@@ -586,12 +586,12 @@ namespace Modbus    // modbus protocol common utilities
         }
 
         for (auto reg: range.RegisterList()) {
-            int w = reg->Get16BitWidth();
-            auto bitWidth = reg->GetBitWidth();
+            int w = reg->GetConfig()->Get16BitWidth();
+            auto bitWidth = reg->GetConfig()->GetBitWidth();
 
             uint64_t r = 0;
 
-            auto addr = GetUint32RegisterAddress(reg->GetAddress());
+            auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
             int wordIndex = (addr - range.GetStart());
             auto reverseWordIndex = w - 1;
 
@@ -600,7 +600,7 @@ namespace Modbus    // modbus protocol common utilities
             while (w--) {
                 uint16_t data = destination[addr - range.GetStart() + w];
 
-                auto localBitOffset = std::max(reg->BitOffset - wordIndex * 16, 0);
+                auto localBitOffset = std::max(reg->GetConfig()->BitOffset - wordIndex * 16, 0);
 
                 auto bitCount = std::min(uint8_t(16 - localBitOffset), bitWidth);
 
@@ -614,7 +614,7 @@ namespace Modbus    // modbus protocol common utilities
                 bitsWritten += bitCount;
 
             }
-            if ((reg->UnsupportedValue) && (*reg->UnsupportedValue == r)) {
+            if ((reg->GetConfig()->UnsupportedValue) && (*reg->GetConfig()->UnsupportedValue == r)) {
                 reg->SetError(ST_DEVICE_ERROR);
                 reg->SetAvailable(false);
             } else {
@@ -634,19 +634,21 @@ namespace Modbus    // modbus protocol common utilities
         }
     }
 
-    std::list<PRegisterRange> SplitRegisterList(const std::list<PRegister>& reg_list, const TDeviceConfig& deviceConfig, bool enableHoles)
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister>& reg_list, const TDeviceConfig& deviceConfig, bool enableHoles)
     {
-        std::list<PRegisterRange> r;
+        std::vector<PRegisterRange> r;
         if (reg_list.empty())
             return r;
 
-        std::list<PRegister> l;
+        // Ranges are sub-spans of the list
+        TRegisterSpan regs(reg_list);
+        size_t start = 0;
         int prev_start = -1, prev_type = -1, prev_end = -1;
         std::chrono::milliseconds prev_interval;
-        int max_hole = enableHoles ? (IsSingleBitType(reg_list.front()->Type) ? deviceConfig.MaxBitHole : deviceConfig.MaxRegHole) : 0;
+        int max_hole = enableHoles ? (IsSingleBitType(reg_list.front()->GetConfig()->Type) ? deviceConfig.MaxBitHole : deviceConfig.MaxRegHole) : 0;
         int max_regs;
 
-        if (IsSingleBitType(reg_list.front()->Type)) {
+        if (IsSingleBitType(reg_list.front()->GetConfig()->Type)) {
             max_regs = MAX_READ_BITS;
         } else {
             if ((deviceConfig.MaxReadRegisters > 0) && (deviceConfig.MaxReadRegisters <= MAX_READ_REGISTERS)) {
@@ -657,37 +659,35 @@ namespace Modbus    // modbus protocol common utilities
         }
 
         bool hasHoles = false;
-        for (auto reg: reg_list) {
-            int addr = GetUint32RegisterAddress(reg->GetAddress());
-            int new_end = addr + reg->Get16BitWidth();
+        for (size_t i = 0; i < regs.size(); ++i) {
+            const auto& reg = regs[i];
+            int addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
+            int new_end = addr + reg->GetConfig()->Get16BitWidth();
             if (!(prev_end >= 0 &&
-                reg->Type == prev_type &&
+                reg->GetConfig()->Type == prev_type &&
                 addr >= prev_end &&
                 addr <= prev_end + max_hole &&
-                reg->PollInterval == prev_interval &&
+                reg->GetConfig()->PollInterval == prev_interval &&
                 new_end - prev_start <= max_regs)) {
-                if (!l.empty()) {
-                    auto range = std::make_shared<TModbusRegisterRange>(l, hasHoles);
+                if (i != start) {
+                    auto range = std::make_shared<TModbusRegisterRange>(regs.Sub(start, i - start), hasHoles);
                     hasHoles = false;
                     LOG(Debug) << "Adding range: " << *range;
                     r.push_back(range);
-                    l.clear();
+                    start = i;
                 }
                 prev_start = addr;
-                prev_type = reg->Type;
-                prev_interval = reg->PollInterval;
+                prev_type = reg->GetConfig()->Type;
+                prev_interval = reg->GetConfig()->PollInterval;
             }
-            if (!l.empty()) {
+            if (i != start) {
                 hasHoles |= (addr != prev_end);
             }
-            l.push_back(reg);
             prev_end = new_end;
         }
-        if (!l.empty()) {
-            auto range = std::make_shared<TModbusRegisterRange>(l, hasHoles);
-            LOG(Debug) << "Adding range: " << *range;
-            r.push_back(range);
-        }
+        auto range = std::make_shared<TModbusRegisterRange>(regs.Sub(start, regs.size() - start), hasHoles);
+        LOG(Debug) << "Adding range: " << *range;
+        r.push_back(range);
         return r;
     }
 
@@ -723,7 +723,7 @@ namespace Modbus    // modbus protocol common utilities
 
         std::unique_ptr<TRegister, std::function<void(TRegister*)>> tmpCacheGuard(&reg, [](TRegister* reg){reg->Device()->DismissTmpCache();});
 
-        LOG(Debug) << "write " << reg.Get16BitWidth() << " " << reg.TypeName << "(s) @ " << reg.GetAddress() <<
+        LOG(Debug) << "write " << reg.GetConfig()->Get16BitWidth() << " " << reg.GetConfig()->TypeName << "(s) @ " << reg.GetConfig()->GetAddress() <<
                 " of device " << reg.Device()->ToString();
 
         // 1 byte - function code, 2 bytes - register address, 2 bytes - value
@@ -800,51 +800,45 @@ namespace Modbus    // modbus protocol common utilities
 
     struct TTruncatedRegisterList
     {
-        bool                 IsValid = false;
-        std::list<PRegister> Regs;
+        bool          IsValid = false;
+        TRegisterSpan Regs;
     };
 
     // Remove unsupported registers on borders
-    TTruncatedRegisterList RemoveUnsupportedFromBorders(const std::list<PRegister>& l)
+    TTruncatedRegisterList RemoveUnsupportedFromBorders(const TRegisterSpan& l)
     {
         TTruncatedRegisterList res;
         auto s = std::find_if(l.begin(), l.end(), [](auto& r) {return r->IsAvailable();});
-        auto e = std::find_if(l.rbegin(), std::make_reverse_iterator(s), [](auto& r) {return r->IsAvailable();});
-        if ((s != l.begin()) || (e != l.rbegin())) {
-            std::copy(s, e.base(), std::back_inserter(res.Regs));
+        auto e = std::find_if(std::make_reverse_iterator(l.end()), std::make_reverse_iterator(s), [](auto& r) {return r->IsAvailable();});
+        if ((s != l.begin()) || (e.base() != l.end())) {
+            res.Regs = l.Sub(s - l.begin(), e.base() - s);
             res.IsValid = true;
         }
         return res;
     }
 
-    std::list<PRegisterRange> SplitRangeByHoles(const std::list<PRegister>& regs, bool onlyAvailable)
+    std::vector<PRegisterRange> SplitRangeByHoles(const TRegisterSpan& regs)
     {
-        std::list<PRegisterRange> newRanges;
-        std::list<PRegister> l;
-        PRegister lastReg;
-        for (auto& reg: regs) {
-            if (!l.empty()) {
-                auto addr = GetUint32RegisterAddress(reg->GetAddress());
-                auto lastAddr = GetUint32RegisterAddress(lastReg->GetAddress());
-                if (lastAddr + 1 != addr) {
-                    newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(l, false));
-                    l.clear();
-                }
-            }
-            if (!onlyAvailable || reg->IsAvailable()) {
-                lastReg = reg;
-                l.push_back(reg);
-            }
+        std::vector<PRegisterRange> newRanges;
+        if (regs.empty()) {
+            return newRanges;
         }
-        if (!l.empty()) {
-            newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(l, false));
+        size_t start = 0;
+        for (size_t i = 1; i < regs.size(); ++i) {
+            auto addr = GetUint32RegisterAddress(regs[i]->GetConfig()->GetAddress());
+            auto lastAddr = GetUint32RegisterAddress(regs[i - 1]->GetConfig()->GetAddress());
+            if (lastAddr + 1 != addr) {
+                newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(regs.Sub(start, i - start), false));
+                start = i;
+            }
         }
+        newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(regs.Sub(start, regs.size() - start), false));
         return newRanges;
     }
 
-    std::list<PRegisterRange> ReadWholeRange(Modbus::IModbusTraits& traits, Modbus::PModbusRegisterRange& range, TPort& port, uint8_t slaveId, int shift)
+    std::vector<PRegisterRange> ReadWholeRange(Modbus::IModbusTraits& traits, Modbus::PModbusRegisterRange& range, TPort& port, uint8_t slaveId, int shift)
     {
-        std::list<PRegisterRange> newRanges;
+        std::vector<PRegisterRange> newRanges;
         try {
             ReadRange(traits, *range, port, slaveId, shift);
             auto res = RemoveUnsupportedFromBorders(range->RegisterList());
@@ -864,7 +858,7 @@ namespace Modbus    // modbus protocol common utilities
             ProcessRangeException(*range, e.what(), ST_DEVICE_ERROR);
             if (range->HasHoles()) {
                 LOG(Debug) << "Disabling holes feature for " << *range;
-                return SplitRangeByHoles(range->RegisterList(), false);
+                return SplitRangeByHoles(range->RegisterList());
             }
             range->SetReadOneByOne(true);
             newRanges.push_back(range);
@@ -872,19 +866,20 @@ namespace Modbus    // modbus protocol common utilities
         return newRanges;
     }
 
-    std::list<PRegisterRange> ReadOneByOne(Modbus::IModbusTraits& traits, Modbus::PModbusRegisterRange& range, TPort& port, uint8_t slaveId, int shift)
+    std::vector<PRegisterRange> ReadOneByOne(Modbus::IModbusTraits& traits, Modbus::PModbusRegisterRange& range, TPort& port, uint8_t slaveId, int shift)
     {
         range->SetStatus(ST_UNKNOWN_ERROR);
-        std::list<Modbus::PModbusRegisterRange> subRanges;
-        for (auto& reg: range->RegisterList()) {
-            subRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(std::list<PRegister>{ reg }, false));
+        std::vector<Modbus::PModbusRegisterRange> subRanges;
+        const auto& regs = range->RegisterList();
+        for (size_t i = 0; i < regs.size(); ++i) {
+            subRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(regs.Sub(i, 1), false));
         }
         for (auto& r: subRanges) {
             try {
                 ReadRange(traits, *r, port, slaveId, shift);
             } catch (const TSerialDeviceTransientErrorException& e) {
                 ProcessRangeException(*range, e.what(), ST_UNKNOWN_ERROR);
-                return std::list<PRegisterRange>{range};
+                return std::vector<PRegisterRange>{range};
             } catch (const TSerialDevicePermanentRegisterException& e) {
                 r->RegisterList().front()->SetAvailable(false);
                 r->RegisterList().front()->SetError(ST_DEVICE_ERROR);
@@ -892,10 +887,30 @@ namespace Modbus    // modbus protocol common utilities
             }
         }
         range->SetStatus(ST_OK);
-        return SplitRangeByHoles(range->RegisterList(), true);;
+
+        // Join available registers back into ranges without holes, sub-spans of the range are merged without allocation
+        std::vector<PRegisterRange> newRanges;
+        TRegisterSpan run;
+        for (size_t i = 0; i < regs.size(); ++i) {
+            if (!regs[i]->IsAvailable()) {
+                continue;
+            }
+            if (!run.empty()) {
+                auto lastAddr = GetUint32RegisterAddress(run.back()->GetConfig()->GetAddress());
+                if (lastAddr + 1 != GetUint32RegisterAddress(regs[i]->GetConfig()->GetAddress())) {
+                    newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(run, false));
+                    run = TRegisterSpan();
+                }
+            }
+            run = run.Merge(regs.Sub(i, 1));
+        }
+        if (!run.empty()) {
+            newRanges.push_back(std::make_shared<Modbus::TModbusRegisterRange>(run, false));
+        }
+        return newRanges;
     }
 
-    std::list<PRegisterRange> ReadRegisterRange(Modbus::IModbusTraits& traits, TPort& port, uint8_t slaveId, PRegisterRange range, int shift)
+    std::vector<PRegisterRange> ReadRegisterRange(Modbus::IModbusTraits& traits, TPort& port, uint8_t slaveId, PRegisterRange range, int shift)
     {
         auto modbus_range = std::dynamic_pointer_cast<Modbus::TModbusRegisterRange>(range);
         if (!modbus_range) {
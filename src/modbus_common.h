@@ -114,11 +114,11 @@ namespace Modbus  // modbus protocol common utilities
             std::unique_ptr<Modbus::IModbusTraits> GetModbusTraits(PPort port) override;
     };
 
-    std::list<PRegisterRange> SplitRegisterList(const std::list<PRegister>& reg_list, const TDeviceConfig& deviceConfig, bool enableHoles);
+    std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister>& reg_list, const TDeviceConfig& deviceConfig, bool enableHoles);
 
     void WriteRegister(IModbusTraits& traits, TPort& port, uint8_t slaveId, TRegister& reg, uint64_t value, int shift = 0);
 
-    std::list<PRegisterRange> ReadRegisterRange(IModbusTraits& traits, TPort& port, uint8_t slaveId, PRegisterRange range, int shift = 0);
+    std::vector<PRegisterRange> ReadRegisterRange(IModbusTraits& traits, TPort& port, uint8_t slaveId, PRegisterRange range, int shift = 0);
 
     bool WriteSetupRegisters(IModbusTraits& traits, TPort& port, uint8_t slaveId, const std::vector<PDeviceSetupItem>& setupItems, int shift = 0);
 
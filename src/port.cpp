@@ -1,6 +1,8 @@
 #include "port.h"
 #include "log.h"
 
+#include <thread>
+
 void TPort::Reopen()
 {
     if (IsOpen()) {
@@ -19,6 +21,11 @@ void TPort::WriteBytes(const std::string& buf)
     WriteBytes(reinterpret_cast<const uint8_t*>(buf.c_str()), buf.size());
 }
 
+void TPort::WaitForOpen(const std::chrono::milliseconds& timeout)
+{
+    std::this_thread::sleep_for(timeout);
+}
+
 std::chrono::milliseconds TPort::GetSendTime(double bytesNumber)
 {
     return std::chrono::milliseconds::zero();
@@ -27,6 +34,16 @@ std::chrono::milliseconds TPort::GetSendTime(double bytesNumber)
 void TPort::SetSerialPortByteFormat(const TSerialPortByteFormat* params)
 {}
 
+bool TPort::SetBaudRate(int baudRate)
+{
+    return false;
+}
+
+PFrameTrace TPort::GetFrameTrace() const
+{
+    return nullptr;
+}
+
 TPortOpenCloseLogic::TPortOpenCloseLogic(const TPortOpenCloseLogic::TSettings& settings)
     : Settings(settings)
 {}
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "serial_port_settings.h"
+#include "frame_trace.h"
 
 class TPort: public std::enable_shared_from_this<TPort> {
 public:
@@ -52,6 +53,14 @@ public:
 
     virtual void SleepSinceLastInteraction(const std::chrono::microseconds& us) = 0;
     virtual bool Wait(const PBinarySemaphore & semaphore, const TTimePoint & until) = 0;
+
+    /**
+     * @brief Wait before next try to open closed port.
+     *        Ports connecting in background return as soon as connection is established.
+     *
+     * @param timeout maximum waiting time
+     */
+    virtual void WaitForOpen(const std::chrono::milliseconds& timeout);
     virtual TTimePoint CurrentTime() const = 0;
 
     /**
@@ -69,6 +78,22 @@ public:
      * @param params pointer to new parameters, if nullptr the port will use default values set on startup
      */
     virtual void SetSerialPortByteFormat(const TSerialPortByteFormat* params);
+
+    /**
+     * @brief Set new baud rate if it is a serial port.
+     *        The rate is changed after all written data is transmitted.
+     *
+     * @param baudRate new baud rate, if 0 the port will use default value set on startup
+     * @return false if the port doesn't support baud rate changing
+     */
+    virtual bool SetBaudRate(int baudRate);
+
+    /**
+     * @brief Get binary trace of port traffic.
+     *
+     * @return nullptr if the port doesn't support tracing
+     */
+    virtual PFrameTrace GetFrameTrace() const;
 };
 
 using PPort = std::shared_ptr<TPort>;
@@ -3,6 +3,7 @@
 #include "bcd_utils.h"
 #include <wblib/utils.h>
 #include <string.h>
+#include <algorithm>
 #include <string>
 
 size_t RegisterFormatByteWidth(RegisterFormat format)
@@ -28,31 +29,89 @@ size_t RegisterFormatByteWidth(RegisterFormat format)
     }
 }
 
-TRegisterRange::TRegisterRange(const std::list<PRegister>& regs): RegList(regs)
+TRegisterSpan::TRegisterSpan(const std::vector<PRegister>& regs)
 {
-    if (RegList.empty())
-        throw std::runtime_error("cannot construct empty register range");
-    PRegister first = regs.front();
-    RegDevice = first->Device();
-    RegType = first->Type;
-    RegTypeName = first->TypeName;
-    RegPollInterval = first->PollInterval;
+    if (regs.empty()) {
+        return;
+    }
+    Device = regs.front()->Device();
+    Table = &Device->GetRegisters();
+    auto ids = std::make_shared<std::vector<uint32_t>>();
+    ids->reserve(regs.size());
+    for (const auto& reg: regs) {
+        if (reg->GetId() >= Table->size() || (*Table)[reg->GetId()] != reg) {
+            throw std::runtime_error("register " + reg->ToString() + " doesn't belong to device's register table");
+        }
+        ids->push_back(reg->GetId());
+    }
+    IdArray = ids;
+    End = regs.size();
+}
+
+TRegisterSpan::TRegisterSpan(PRegister reg)
+    : Device(reg->Device()),
+      Table(&Device->GetRegisters()),
+      SingleId(reg->GetId()),
+      End(1)
+{}
+
+TRegisterSpan TRegisterSpan::Sub(size_t pos, size_t count) const
+{
+    if (pos + count > size()) {
+        throw std::out_of_range("register span is out of range");
+    }
+    TRegisterSpan res(*this);
+    res.Begin = Begin + pos;
+    res.End = res.Begin + count;
+    return res;
 }
 
-TRegisterRange::TRegisterRange(PRegister reg): RegList(1, reg)
+TRegisterSpan TRegisterSpan::Merge(const TRegisterSpan& next) const
 {
-    RegDevice = reg->Device();
-    RegType = reg->Type;
-    RegTypeName = reg->TypeName;
-    RegPollInterval = reg->PollInterval;
+    if (next.empty()) {
+        return *this;
+    }
+    if (empty()) {
+        return next;
+    }
+    if (IdArray && IdArray == next.IdArray && End == next.Begin) {
+        TRegisterSpan res(*this);
+        res.End = next.End;
+        return res;
+    }
+    std::vector<PRegister> regs(begin(), end());
+    regs.insert(regs.end(), next.begin(), next.end());
+    return TRegisterSpan(regs);
 }
 
-const std::list<PRegister>& TRegisterRange::RegisterList() const
+bool TRegisterSpan::operator==(const TRegisterSpan& other) const
 {
-    return RegList;
+    return std::equal(begin(), end(), other.begin(), other.end());
+}
+
+bool TRegisterSpan::operator!=(const TRegisterSpan& other) const
+{
+    return !(*this == other);
 }
 
-std::list<PRegister>& TRegisterRange::RegisterList()
+TRegisterRange::TRegisterRange(const TRegisterSpan& regs): RegList(regs)
+{
+    if (RegList.empty())
+        throw std::runtime_error("cannot construct empty register range");
+    PRegister first = RegList.front();
+    RegDevice = first->Device();
+    RegType = first->GetConfig()->Type;
+    RegTypeName = first->GetConfig()->TypeName;
+    RegPollInterval = first->GetConfig()->PollInterval;
+}
+
+TRegisterRange::TRegisterRange(const std::vector<PRegister>& regs): TRegisterRange(TRegisterSpan(regs))
+{}
+
+TRegisterRange::TRegisterRange(PRegister reg): TRegisterRange(TRegisterSpan(reg))
+{}
+
+const TRegisterSpan& TRegisterRange::RegisterList() const
 {
     return RegList;
 }
@@ -84,7 +143,9 @@ void TRegisterRange::SetError(EStatus error)
     }
 }
 
-TSimpleRegisterRange::TSimpleRegisterRange(const std::list<PRegister>& regs): TRegisterRange(regs) {}
+TSimpleRegisterRange::TSimpleRegisterRange(const TRegisterSpan& regs): TRegisterRange(regs) {}
+
+TSimpleRegisterRange::TSimpleRegisterRange(const std::vector<PRegister>& regs): TRegisterRange(regs) {}
 
 TSimpleRegisterRange::TSimpleRegisterRange(PRegister reg): TRegisterRange(reg) {}
 
@@ -128,12 +189,20 @@ const IRegisterAddress& TRegisterConfig::GetAddress() const
     return *Address;
 }
 
+const uint32_t TRegister::NO_CLIENT_INDEX;
+
+TRegister::TRegister(PSerialDevice device, PRegisterConfig config, uint32_t id)
+    : Config(config),
+      _Device(device),
+      Id(id)
+{}
+
 std::string TRegister::ToString() const
 {
     if (Device()) {
-        return "<" + Device()->ToString() + ":" + TRegisterConfig::ToString() + ">";
+        return "<" + Device()->ToString() + ":" + Config->ToString() + ">";
     }
-    return "<unknown device:" + TRegisterConfig::ToString() + ">";
+    return "<unknown device:" + Config->ToString() + ">";
 }
 
 bool TRegister::IsAvailable() const
@@ -168,8 +237,10 @@ void TRegister::SetValue(uint64_t value)
     Available = true;
 }
 
-std::map<std::tuple<PSerialDevice, PRegisterConfig>, PRegister> TRegister::RegStorage;
-std::mutex TRegister::Mutex;
+PRegister TRegister::Intern(PSerialDevice device, PRegisterConfig config)
+{
+    return device->GetRegister(config);
+}
 
 TRegisterConfig::TRegisterConfig(int type,
                                  std::shared_ptr<IRegisterAddress> address,
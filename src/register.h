@@ -13,6 +13,7 @@
 #include <mutex>
 #include <tuple>
 #include <cmath>
+#include <cstdint>
 
 #include "serial_exc.h"
 
@@ -93,6 +94,7 @@ typedef std::shared_ptr<TRegisterTypeMap> PRegisterTypeMap;
 
 struct TRegisterConfig;
 typedef std::shared_ptr<TRegisterConfig> PRegisterConfig;
+typedef std::shared_ptr<const TRegisterConfig> PConstRegisterConfig;
 
 class TSerialDevice;
 typedef std::shared_ptr<TSerialDevice> PSerialDevice;
@@ -256,15 +258,14 @@ public:
 struct TRegister;
 typedef std::shared_ptr<TRegister> PRegister;
 
-struct TRegister : public TRegisterConfig
+/**
+ * @brief Register of a device.
+ *        Config is shared between all registers created from it and must not be changed after register creation.
+ *        Registers are owned by a device (see TSerialDevice::GetRegister) and have device-wide unique ids.
+ */
+struct TRegister
 {
-    TRegister(PSerialDevice device, PRegisterConfig config)
-        : TRegisterConfig(*config)
-        , _Device(device)
-    {}
-
-    ~TRegister()
-    {}
+    TRegister(PSerialDevice device, PRegisterConfig config, uint32_t id = 0);
 
     std::string ToString() const;
 
@@ -273,6 +274,28 @@ struct TRegister : public TRegisterConfig
         return _Device.lock();
     }
 
+    const PConstRegisterConfig& GetConfig() const
+    {
+        return Config;
+    }
+
+    //! Index of the register in device's register table
+    uint32_t GetId() const
+    {
+        return Id;
+    }
+
+    //! Index of the register in serial client's tables, NO_CLIENT_INDEX if the register is not added to a client
+    uint32_t GetClientIndex() const
+    {
+        return ClientIndex;
+    }
+
+    void SetClientIndex(uint32_t index)
+    {
+        ClientIndex = index;
+    }
+
     //! The register is available in the device. It is allowed to read or write it
     bool IsAvailable() const;
 
@@ -285,43 +308,27 @@ struct TRegister : public TRegisterConfig
     uint64_t GetValue() const;
     void SetValue(uint64_t value);
 
-private:
-    std::weak_ptr<TSerialDevice> _Device;
-    bool Available = true;
-    EStatus Error = ST_UNKNOWN_ERROR;
-    uint64_t Value;
-
-    // Intern() implementation for TRegister
-private:
-    static std::map<std::tuple<PSerialDevice, PRegisterConfig>, PRegister> RegStorage;
-    static std::mutex Mutex;
-
-public:
-    static PRegister Intern(PSerialDevice device, PRegisterConfig config)
-    {
-        std::unique_lock<std::mutex> lock(Mutex); // thread-safe
-        std::tuple<PSerialDevice, PRegisterConfig> args(device, config);
-
-        auto it = RegStorage.find(args);
-
-        if (it == RegStorage.end()) {
-            auto ret = std::make_shared<TRegister>(device, config);
-            return RegStorage[args] = ret;
-        }
+    /**
+     * @brief Get register of the device for the config.
+     *        Creates a new register in device's register table on first call with the config.
+     */
+    static PRegister Intern(PSerialDevice device, PRegisterConfig config);
 
-        return it->second;
-    }
-
-    static void DeleteIntern()
-    {
-        RegStorage.clear();
-    }
+    static const uint32_t NO_CLIENT_INDEX = UINT32_MAX;
 
+private:
+    PConstRegisterConfig         Config;
+    std::weak_ptr<TSerialDevice> _Device;
+    uint64_t                     Value = 0;
+    uint32_t                     Id;
+    uint32_t                     ClientIndex = NO_CLIENT_INDEX;
+    EStatus                      Error = ST_UNKNOWN_ERROR;
+    bool                         Available = true;
 };
 
 typedef std::vector<PRegister> TRegistersList;
 
-inline ::std::ostream& operator<<(::std::ostream& os, PRegisterConfig reg) {
+inline ::std::ostream& operator<<(::std::ostream& os, PConstRegisterConfig reg) {
     return os << reg->ToString();
 }
 
@@ -424,6 +431,133 @@ inline EWordOrder WordOrderFromName(const std::string& name) {
         return EWordOrder::BigEndian;
 }
 
+/**
+ * @brief Registers of a range: a span of ids in device's register table.
+ *        Ids are stored in an array shared by all sub-spans made from it,
+ *        so splitting a span and merging sub-spans back don't copy ids and don't allocate memory.
+ *        The span holds a reference to the device, so the table stays valid while the span exists.
+ */
+class TRegisterSpan
+{
+public:
+    class TIterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef PRegister                       value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const PRegister*                pointer;
+        typedef const PRegister&                reference;
+
+        TIterator(const std::vector<PRegister>* table = nullptr, const uint32_t* id = nullptr): Table(table), Id(id)
+        {}
+
+        reference operator*() const { return (*Table)[*Id]; }
+        pointer operator->() const { return &(*Table)[*Id]; }
+        reference operator[](difference_type n) const { return (*Table)[Id[n]]; }
+
+        TIterator& operator++() { ++Id; return *this; }
+        TIterator& operator--() { --Id; return *this; }
+        TIterator operator++(int) { auto it = *this; ++Id; return it; }
+        TIterator operator--(int) { auto it = *this; --Id; return it; }
+        TIterator& operator+=(difference_type n) { Id += n; return *this; }
+        TIterator& operator-=(difference_type n) { Id -= n; return *this; }
+        TIterator operator+(difference_type n) const { return TIterator(Table, Id + n); }
+        TIterator operator-(difference_type n) const { return TIterator(Table, Id - n); }
+        difference_type operator-(const TIterator& it) const { return Id - it.Id; }
+
+        bool operator==(const TIterator& it) const { return Id == it.Id; }
+        bool operator!=(const TIterator& it) const { return Id != it.Id; }
+        bool operator<(const TIterator& it) const { return Id < it.Id; }
+        bool operator>(const TIterator& it) const { return Id > it.Id; }
+        bool operator<=(const TIterator& it) const { return Id <= it.Id; }
+        bool operator>=(const TIterator& it) const { return Id >= it.Id; }
+
+    private:
+        const std::vector<PRegister>* Table;
+        const uint32_t*               Id;
+    };
+
+    typedef TIterator iterator;
+    typedef TIterator const_iterator;
+    typedef PRegister value_type;
+
+    TRegisterSpan() = default;
+
+    /**
+     * @brief Make a span of registers in the order of the list.
+     *        All registers must belong to the same device. Allocates the id array once.
+     */
+    explicit TRegisterSpan(const std::vector<PRegister>& regs);
+
+    //! Make a span of one register, ids array is not allocated
+    explicit TRegisterSpan(PRegister reg);
+
+    TIterator begin() const
+    {
+        return TIterator(Table, Ids() + Begin);
+    }
+
+    TIterator end() const
+    {
+        return TIterator(Table, Ids() + End);
+    }
+
+    size_t size() const
+    {
+        return End - Begin;
+    }
+
+    bool empty() const
+    {
+        return End == Begin;
+    }
+
+    const PRegister& operator[](size_t i) const
+    {
+        return (*Table)[Ids()[Begin + i]];
+    }
+
+    const PRegister& front() const
+    {
+        return (*this)[0];
+    }
+
+    const PRegister& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    //! Span of count registers starting from pos. Shares ids with this span
+    TRegisterSpan Sub(size_t pos, size_t count) const;
+
+    /**
+     * @brief Span of registers of this span followed by registers of next one.
+     *        Adjacent sub-spans of one span are joined without allocation, otherwise ids are copied.
+     */
+    TRegisterSpan Merge(const TRegisterSpan& next) const;
+
+    //! Same registers in the same order
+    bool operator==(const TRegisterSpan& other) const;
+    bool operator!=(const TRegisterSpan& other) const;
+
+private:
+    const uint32_t* Ids() const
+    {
+        return IdArray ? IdArray->data() : &SingleId;
+    }
+
+    PSerialDevice                                Device;
+    const std::vector<PRegister>*                Table = nullptr;
+    std::shared_ptr<const std::vector<uint32_t>> IdArray;
+    uint32_t                                     SingleId = 0;
+    uint32_t                                     Begin = 0;
+    uint32_t                                     End = 0;
+};
+
+/**
+ * @brief Registers read by one request.
+ */
 class TRegisterRange {
 public:
     typedef std::function<void(PRegister reg, uint64_t new_value)> TValueCallback;
@@ -431,8 +565,7 @@ public:
 
     virtual ~TRegisterRange() = default;
 
-    const std::list<PRegister>& RegisterList() const;
-    std::list<PRegister>& RegisterList();
+    const TRegisterSpan& RegisterList() const;
     PSerialDevice Device() const;
     int Type() const;
     std::string TypeName() const;
@@ -446,7 +579,8 @@ public:
     virtual EStatus GetStatus() const = 0;
 
 protected:
-    TRegisterRange(const std::list<PRegister>& regs);
+    TRegisterRange(const TRegisterSpan& regs);
+    TRegisterRange(const std::vector<PRegister>& regs);
     TRegisterRange(PRegister reg);
 
 private:
@@ -454,14 +588,15 @@ private:
     int RegType;
     std::string RegTypeName;
     std::chrono::milliseconds RegPollInterval = std::chrono::milliseconds(-1);
-    std::list<PRegister> RegList;
+    TRegisterSpan RegList;
 };
 
 typedef std::shared_ptr<TRegisterRange> PRegisterRange;
 
 class TSimpleRegisterRange: public TRegisterRange {
 public:
-    TSimpleRegisterRange(const std::list<PRegister>& regs);
+    TSimpleRegisterRange(const TRegisterSpan& regs);
+    TSimpleRegisterRange(const std::vector<PRegister>& regs);
     TSimpleRegisterRange(PRegister reg);
 
     EStatus GetStatus() const override;
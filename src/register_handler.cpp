@@ -1,6 +1,8 @@
 #include "register_handler.h"
 #include "log.h"
 
+#include <algorithm>
+
 #define LOG(logger) ::logger.Log() << "[register handler] "
 
 using namespace std::chrono;
@@ -11,8 +13,26 @@ namespace
     const seconds MAX_WRITE_FAIL_TIME(600); // 10 minutes
 }
 
-TRegisterHandler::TRegisterHandler(PSerialDevice dev, PRegister reg, PBinarySemaphore flush_needed)
-    : Dev(dev), Reg(reg), FlushNeeded(flush_needed), WriteFail(false)
+void TFlushQueue::Push(TRegisterHandler* handler)
+{
+    auto head = Head.load(std::memory_order_relaxed);
+    do {
+        handler->NextInFlushQueue = head;
+    } while (!Head.compare_exchange_weak(head, handler, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void TFlushQueue::PopAll(std::vector<TRegisterHandler*>& handlers)
+{
+    // Handlers are pushed in LIFO order, so reverse the detached chain
+    auto first = handlers.size();
+    for (auto handler = Head.exchange(nullptr, std::memory_order_acquire); handler; handler = handler->NextInFlushQueue) {
+        handlers.push_back(handler);
+    }
+    std::reverse(handlers.begin() + first, handlers.end());
+}
+
+TRegisterHandler::TRegisterHandler(PSerialDevice dev, PRegister reg, PBinarySemaphore flush_needed, PFlushQueue flush_queue)
+    : Dev(dev), Reg(reg), FlushNeeded(flush_needed), FlushQueue(flush_queue)
 {}
 
 TRegisterHandler::TErrorState TRegisterHandler::UpdateReadError(bool error) {
@@ -54,8 +74,7 @@ TRegisterHandler::TErrorState TRegisterHandler::UpdateWriteError(bool error)
 
 bool TRegisterHandler::NeedToPoll()
 {
-    std::lock_guard<std::mutex> lock(SetValueMutex);
-    return Reg->Poll;
+    return Reg->GetConfig()->Poll;
 }
 
 TRegisterHandler::TErrorState TRegisterHandler::AcceptDeviceValue(uint64_t new_value, bool ok, bool *changed)
@@ -68,32 +87,25 @@ TRegisterHandler::TErrorState TRegisterHandler::AcceptDeviceValue(uint64_t new_v
     bool first_poll = !DidReadReg;
     DidReadReg = true;
 
-    if (Reg->ErrorValue && InvertWordOrderIfNeeded(*Reg, *Reg->ErrorValue) == new_value) {
+    if (Reg->GetConfig()->ErrorValue && InvertWordOrderIfNeeded(*Reg->GetConfig(), *Reg->GetConfig()->ErrorValue) == new_value) {
         LOG(Debug) << "register " << Reg->ToString() << " contains error value";
         return UpdateReadError(true);
     }
 
-    SetValueMutex.lock();
-
     if (OldValue != new_value) {
         OldValue = new_value;
-        SetValueMutex.unlock();
-
         LOG(Debug) << "new val for " << Reg->ToString() << ": " << std::hex << new_value;
         *changed = true;
         return UpdateReadError(false);
     }
 
-    SetValueMutex.unlock();
-
     *changed = first_poll;
     return UpdateReadError(false);
 }
 
 bool TRegisterHandler::NeedToFlush()
 {
-    std::lock_guard<std::mutex> lock(SetValueMutex);
-    return Dirty;
+    return SetSequence.load(std::memory_order_acquire) != FlushedSequence;
 }
 
 TRegisterHandler::TFlushResult TRegisterHandler::Flush(TErrorState forcedError)
@@ -102,43 +114,34 @@ TRegisterHandler::TFlushResult TRegisterHandler::Flush(TErrorState forcedError)
         return { UpdateWriteError(true), false };
     }
 
+    // Acquire on the sequence makes the value stored before its increment visible.
+    // A newer value set after reading the sequence will be written on next flush.
+    auto sequence = SetSequence.load(std::memory_order_acquire);
+    uint64_t tempValue = ValueToSet.load(std::memory_order_relaxed);
+
     bool changed = false;
-    volatile uint64_t tempValue;
     try {
-        {
-            std::lock_guard<std::mutex> lock(SetValueMutex);
-            tempValue = ValueToSet;
-        }
         Device()->WriteRegister(Reg, tempValue);
-        {
-            std::lock_guard<std::mutex> lock(SetValueMutex);
-            Dirty = (tempValue != ValueToSet);
-            WriteFail = false;
-        }
+        FlushedSequence = sequence;
+        WriteFail = false;
         changed = (OldValue != tempValue);
         OldValue = tempValue;
         Reg->SetValue(OldValue);
     } catch (const TSerialDeviceTransientErrorException& e) {
         LOG(Warn) << "failed to write: " << Reg->ToString() << ": " << e.what();
-        {
-            std::lock_guard<std::mutex> lock(SetValueMutex);
-            if (!WriteFail) {
-                WriteFirstTryTime = steady_clock::now();
-            }
-            WriteFail = true;
-            if (duration_cast<seconds>(steady_clock::now() - WriteFirstTryTime) > MAX_WRITE_FAIL_TIME) {
-                Dirty = (tempValue != ValueToSet);
-                WriteFail = false;
-            }
+        if (!WriteFail) {
+            WriteFirstTryTime = steady_clock::now();
+        }
+        WriteFail = true;
+        if (duration_cast<seconds>(steady_clock::now() - WriteFirstTryTime) > MAX_WRITE_FAIL_TIME) {
+            FlushedSequence = sequence;
+            WriteFail = false;
         }
         return { UpdateWriteError(true), false };
     } catch (const TSerialDevicePermanentRegisterException& e) {
         LOG(Warn) << "failed to write: " << Reg->ToString() << ": " << e.what();
-        {
-            std::lock_guard<std::mutex> lock(SetValueMutex);
-            Dirty = (tempValue != ValueToSet);
-            WriteFail = false;
-        }
+        FlushedSequence = sequence;
+        WriteFail = false;
         return { UpdateWriteError(true), false };
     }
     return { UpdateWriteError(false), changed };
@@ -146,16 +149,26 @@ TRegisterHandler::TFlushResult TRegisterHandler::Flush(TErrorState forcedError)
 
 std::string TRegisterHandler::TextValue() const
 {
-    return ConvertFromRawValue(*Reg, Reg->GetValue());
+    return ConvertFromRawValue(*Reg->GetConfig(), Reg->GetValue());
+}
+
+bool TRegisterHandler::KeepInFlushQueue()
+{
+    // SetTextValue increments SetSequence and then tries to take InFlushQueue.
+    // Both sides use sequentially consistent operations, so either SetTextValue sees
+    // the released flag and pushes the handler, or the check below sees the new value.
+    // NeedToFlush's acquire load may be reordered before the store, so the sequence is loaded here.
+    InFlushQueue.store(false);
+    return SetSequence.load() != FlushedSequence && !InFlushQueue.exchange(true);
 }
 
 void TRegisterHandler::SetTextValue(const std::string& v)
 {
-    {
-        // don't hold the lock while notifying the client below
-        std::lock_guard<std::mutex> lock(SetValueMutex);
-        Dirty = true;
-        ValueToSet = ConvertToRawValue(*Reg, v);
+    ValueToSet.store(ConvertToRawValue(*Reg->GetConfig(), v), std::memory_order_relaxed);
+    SetSequence.fetch_add(1);
+    // the handler is queued only once, following values overwrite ValueToSet
+    if (!InFlushQueue.exchange(true)) {
+        FlushQueue->Push(this);
     }
     FlushNeeded->Signal();
 }
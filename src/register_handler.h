@@ -1,6 +1,7 @@
 #pragma once
 #include <cmath>
-#include <mutex>
+#include <atomic>
+#include <vector>
 #include <memory>
 #include <string>
 #include <wblib/utils.h>
@@ -11,6 +12,26 @@
 
 using WBMQTT::StringFormat;
 
+class TRegisterHandler;
+
+/**
+ * @brief Lock-free queue of register handlers with pending writes.
+ *        Any thread can push, only the serial client thread pops.
+ */
+class TFlushQueue
+{
+public:
+    void Push(TRegisterHandler* handler);
+
+    //! Append all queued handlers to the vector in order of pushing
+    void PopAll(std::vector<TRegisterHandler*>& handlers);
+
+private:
+    std::atomic<TRegisterHandler*> Head{nullptr};
+};
+
+typedef std::shared_ptr<TFlushQueue> PFlushQueue;
+
 class TRegisterHandler
 {
 public:
@@ -22,7 +43,7 @@ public:
         UnknownErrorState,
         ErrorStateUnchanged
     };
-    TRegisterHandler(PSerialDevice dev, PRegister reg, PBinarySemaphore flush_needed);
+    TRegisterHandler(PSerialDevice dev, PRegister reg, PBinarySemaphore flush_needed, PFlushQueue flush_queue);
     PRegister Register() const { return Reg; }
     bool NeedToPoll();
     TErrorState AcceptDeviceValue(uint64_t new_value, bool ok, bool* changed);
@@ -38,6 +59,14 @@ public:
      * @brief Write pending register value. NeedToFlush must be checked before call.
      */
     TFlushResult Flush(TErrorState forcedError = NoError);
+
+    /**
+     * @brief Called by flush queue consumer after processing the handler.
+     *        Returns true if the handler still has a pending value and must be kept for the next flush.
+     *        Otherwise the next SetTextValue will push the handler to the flush queue again.
+     */
+    bool KeepInFlushQueue();
+
     std::string TextValue() const;
 
     void SetTextValue(const std::string& v);
@@ -46,20 +75,31 @@ public:
     PSerialDevice Device() const { return Dev.lock(); }
 
 private:
+    friend class TFlushQueue;
+
     TErrorState UpdateReadError(bool error);
     TErrorState UpdateWriteError(bool error);
 
     std::weak_ptr<TSerialDevice> Dev;
-    uint64_t OldValue = 0;
-    uint64_t ValueToSet = 0;
     PRegister Reg;
-    volatile bool Dirty = false;
+
+    // Port thread state
+    uint64_t OldValue = 0;
+    uint64_t FlushedSequence = 0;
     bool DidReadReg = false;
-    std::mutex SetValueMutex;
     TErrorState ErrorState = UnknownErrorState;
-    PBinarySemaphore FlushNeeded;
-    bool WriteFail;
+    bool WriteFail = false;
     std::chrono::steady_clock::time_point WriteFirstTryTime;
+
+    // Single slot mailbox filled by SetTextValue from any thread.
+    // The value is pending while SetSequence differs from FlushedSequence.
+    std::atomic<uint64_t> ValueToSet{0};
+    std::atomic<uint64_t> SetSequence{0};
+    std::atomic<bool> InFlushQueue{false};
+
+    PBinarySemaphore FlushNeeded;
+    PFlushQueue FlushQueue;
+    TRegisterHandler* NextInFlushQueue = nullptr;
 };
 
 typedef std::shared_ptr<TRegisterHandler> PRegisterHandler;
@@ -0,0 +1,255 @@
+#include "replay_port.h"
+#include "serial_exc.h"
+#include "binary_semaphore.h"
+#include "log.h"
+#include "serial_port.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string.h>
+#include <thread>
+
+#define LOG(logger) ::logger.Log() << "[replay] "
+
+using namespace std;
+
+namespace
+{
+    string ToHex(const uint8_t* buf, size_t size)
+    {
+        stringstream ss;
+        ss << hex << setfill('0');
+        for (size_t i = 0; i < size; ++i) {
+            ss << (i ? " " : "") << setw(2) << int(buf[i]);
+        }
+        return ss.str();
+    }
+}
+
+TReplayPort::TReplayPort(const vector<TFrameCaptureRecord>& records,
+                         const string&                      description,
+                         double                             speed,
+                         bool                               serial)
+    : PendingReadPos(0),
+      Description(description),
+      Speed(speed),
+      Serial(serial),
+      Opened(false),
+      FinishReported(false),
+      StartTime(chrono::steady_clock::now())
+{
+    if (Speed <= 0) {
+        throw runtime_error("replay speed must be positive");
+    }
+    for (const auto& record: records) {
+        if (record.Type != TFrameCaptureRecordType::Port) {
+            // A part of the frame is lost, replay would feed corrupted data to devices
+            if (record.Truncated) {
+                throw runtime_error("capture of " + description + " contains truncated frame");
+            }
+            Records.push_back(record);
+        }
+    }
+    LastInteraction = CurrentTime();
+}
+
+void TReplayPort::Open()
+{
+    if (Opened) {
+        throw TSerialDeviceException("port is already open");
+    }
+    Opened = true;
+}
+
+void TReplayPort::Close()
+{
+    CheckPortOpen();
+    Opened = false;
+    PendingRead.clear();
+    PendingReadPos = 0;
+}
+
+bool TReplayPort::IsOpen() const
+{
+    return Opened;
+}
+
+void TReplayPort::CheckPortOpen() const
+{
+    if (!Opened) {
+        throw TSerialDeviceException("port not open");
+    }
+}
+
+void TReplayPort::WriteBytes(const uint8_t* buf, int count)
+{
+    CheckPortOpen();
+    LastInteraction = CurrentTime();
+
+    // Responses to previous request are not needed anymore
+    PendingRead.clear();
+    PendingReadPos = 0;
+    size_t skipped = 0;
+    while (!Records.empty() && Records.front().Type != TFrameCaptureRecordType::Write) {
+        if (Records.front().Type == TFrameCaptureRecordType::Read) {
+            ++skipped;
+        }
+        Records.pop_front();
+    }
+    if (skipped) {
+        LOG(Warn) << Description << ": " << skipped << " recorded response(s) are not read";
+    }
+    if (Records.empty()) {
+        CheckFinished();
+        return;
+    }
+
+    const auto& request = Records.front().Data;
+    if (request.size() != static_cast<size_t>(count) || memcmp(request.data(), buf, count)) {
+        LOG(Warn) << Description << ": request mismatch, recorded: " << ToHex(request.data(), request.size())
+                  << ", written: " << ToHex(buf, count);
+    }
+    Records.pop_front();
+}
+
+bool TReplayPort::NextIsRead() const
+{
+    return !Records.empty() && Records.front().Type == TFrameCaptureRecordType::Read;
+}
+
+void TReplayPort::CheckFinished()
+{
+    if (Records.empty() && !FinishReported) {
+        FinishReported = true;
+        LOG(Info) << Description << ": all recorded frames are replayed";
+    }
+}
+
+uint8_t TReplayPort::ReadByte(const chrono::microseconds& timeout)
+{
+    CheckPortOpen();
+    if (PendingReadPos == PendingRead.size()) {
+        if (!NextIsRead()) {
+            CheckFinished();
+            throw TSerialDeviceTransientErrorException("timeout");
+        }
+        PendingRead = move(Records.front().Data);
+        PendingReadPos = 0;
+        Records.pop_front();
+    }
+    LastInteraction = CurrentTime();
+    return PendingRead[PendingReadPos++];
+}
+
+size_t TReplayPort::ReadFrame(uint8_t*                   buf,
+                              size_t                     count,
+                              const chrono::microseconds& responseTimeout,
+                              const chrono::microseconds& frameTimeout,
+                              TFrameCompletePred         frame_complete)
+{
+    CheckPortOpen();
+    if (PendingReadPos == PendingRead.size()) {
+        if (!NextIsRead()) {
+            CheckFinished();
+            throw TSerialDeviceTransientErrorException("request timed out");
+        }
+        PendingRead = move(Records.front().Data);
+        PendingReadPos = 0;
+        Records.pop_front();
+    }
+    auto nread = min(count, PendingRead.size() - PendingReadPos);
+    memcpy(buf, PendingRead.data() + PendingReadPos, nread);
+    PendingReadPos += nread;
+    LastInteraction = CurrentTime();
+    return nread;
+}
+
+void TReplayPort::SkipNoise()
+{
+    PendingRead.clear();
+    PendingReadPos = 0;
+    while (!Records.empty() && Records.front().Type == TFrameCaptureRecordType::Noise) {
+        Records.pop_front();
+    }
+}
+
+void TReplayPort::SleepSinceLastInteraction(const chrono::microseconds& us)
+{
+    auto delta = chrono::duration_cast<chrono::microseconds>(CurrentTime() - LastInteraction);
+    if (us > delta) {
+        this_thread::sleep_for(chrono::duration_cast<chrono::microseconds>((us - delta) / Speed));
+    }
+}
+
+bool TReplayPort::Wait(const PBinarySemaphore& semaphore, const TTimePoint& until)
+{
+    auto delta = chrono::duration_cast<chrono::microseconds>(until - CurrentTime());
+    if (delta.count() < 0) {
+        delta = chrono::microseconds::zero();
+    }
+    return semaphore->Wait(chrono::steady_clock::now() + chrono::duration_cast<chrono::microseconds>(delta / Speed));
+}
+
+TTimePoint TReplayPort::CurrentTime() const
+{
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - StartTime);
+    return StartTime + chrono::duration_cast<chrono::microseconds>(elapsed * Speed);
+}
+
+string TReplayPort::GetDescription(bool verbose) const
+{
+    if (verbose) {
+        return "replay of " + Description;
+    }
+    return Description;
+}
+
+bool TReplayPort::SetBaudRate(int baudRate)
+{
+    // Traffic is replayed as captured, so only support of rate changing matters
+    return Serial;
+}
+
+bool TReplayPort::IsFinished() const
+{
+    return Records.empty() && PendingReadPos == PendingRead.size();
+}
+
+TPortFactoryFn MakeReplayPortFactory(const string& fileName, double speed)
+{
+    auto records = make_shared<vector<TFrameCaptureRecord>>(ReadFrameCapture(fileName));
+    return [=](const Json::Value& port_data, size_t connection) {
+        auto port = DefaultPortFactory(port_data, connection);
+        auto description = port.first->GetDescription();
+        auto id = GetPortId(description, connection);
+
+        // Port indexes are unique per capture file
+        int index = -1;
+        for (const auto& record: *records) {
+            if (record.Type == TFrameCaptureRecordType::Port &&
+                string(record.Data.begin(), record.Data.end()) == id)
+            {
+                index = record.Port;
+                break;
+            }
+        }
+        if (index < 0) {
+            LOG(Warn) << id << " is not found in capture " << fileName;
+        }
+
+        vector<TFrameCaptureRecord> portRecords;
+        for (const auto& record: *records) {
+            if (record.Port == index) {
+                portRecords.push_back(record);
+            }
+        }
+
+        auto serialPort = dynamic_pointer_cast<TSerialPortWithIECHack>(port.first);
+        PPort replayPort = make_shared<TReplayPort>(portRecords, id, speed, serialPort != nullptr);
+        if (serialPort) {
+            replayPort = make_shared<TSerialPortWithIECHack>(replayPort, serialPort->GetSettings());
+        }
+        return make_pair(replayPort, port.second);
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "port.h"
+#include "frame_capture.h"
+#include "serial_config.h"
+
+#include <deque>
+
+/*!
+ * Port feeding traffic recorded by TFrameCaptureWriter to a serial client.
+ * Written data is compared with recorded requests, reads return recorded responses.
+ * Timing is reproduced with speed multiplier: CurrentTime runs Speed times faster than real time.
+ */
+class TReplayPort: public TPort
+{
+public:
+    /**
+     * @brief Construct a new TReplayPort object
+     *
+     * @param records records of the port, Port records are ignored.
+     *                Throws std::runtime_error if a frame is truncated.
+     * @param description description of the captured port
+     * @param speed replay speed multiplier
+     * @param serial the captured port is a serial port, it supports baud rate changing
+     */
+    TReplayPort(const std::vector<TFrameCaptureRecord>& records,
+                const std::string&                      description,
+                double                                  speed = 1,
+                bool                                    serial = false);
+
+    void Open() override;
+    void Close() override;
+    bool IsOpen() const override;
+    void CheckPortOpen() const override;
+
+    void WriteBytes(const uint8_t* buf, int count) override;
+    uint8_t ReadByte(const std::chrono::microseconds& timeout) override;
+    size_t ReadFrame(uint8_t* buf,
+                     size_t count,
+                     const std::chrono::microseconds& responseTimeout,
+                     const std::chrono::microseconds& frameTimeout,
+                     TFrameCompletePred frame_complete = 0) override;
+    void SkipNoise() override;
+
+    void SleepSinceLastInteraction(const std::chrono::microseconds& us) override;
+    bool Wait(const PBinarySemaphore& semaphore, const TTimePoint& until) override;
+    TTimePoint CurrentTime() const override;
+
+    std::string GetDescription(bool verbose = true) const override;
+
+    bool SetBaudRate(int baudRate) override;
+
+    //! Returns true if all recorded frames are replayed
+    bool IsFinished() const;
+
+private:
+    bool NextIsRead() const;
+    void CheckFinished();
+
+    std::deque<TFrameCaptureRecord> Records;
+    std::vector<uint8_t>            PendingRead;
+    size_t                          PendingReadPos;
+    std::string                     Description;
+    double                          Speed;
+    bool                            Serial;
+    bool                            Opened;
+    bool                            FinishReported;
+    TTimePoint                      StartTime;
+    TTimePoint                      LastInteraction;
+};
+
+/**
+ * @brief Create port factory for LoadConfig replacing ports from config by replay ports.
+ *        Ports are matched by id (see GetPortId). Ports without traffic in capture get empty replay.
+ *        Replay ports of serial ports are wrapped the same way as live ones.
+ *
+ * @param fileName capture file
+ * @param speed replay speed multiplier
+ */
+TPortFactoryFn MakeReplayPortFactory(const std::string& fileName, double speed);
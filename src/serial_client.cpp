@@ -2,6 +2,7 @@
 
 #include <unistd.h>
 #include <unordered_map>
+#include <algorithm>
 #include <iostream>
 
 #define LOG(logger) logger.Log() << "[serial client] "
@@ -17,7 +18,7 @@ namespace
         std::chrono::milliseconds PollInterval() const {
             return Ranges.front()->PollInterval();
         }
-        std::list<PRegisterRange> Ranges;
+        std::vector<PRegisterRange> Ranges;
     };
     typedef std::shared_ptr<TSerialPollEntry> PSerialPollEntry;
 };
@@ -31,6 +32,7 @@ TSerialClient::TSerialClient(const std::vector<PSerialDevice>& devices,
       ReadCallback([](PRegister, bool){}),
       ErrorCallback([](PRegister, bool){}),
       FlushNeeded(new TBinarySemaphore),
+      FlushQueue(new TFlushQueue),
       Plan(std::make_shared<TPollPlan>([this]() { return Port->CurrentTime(); })),
       OpenCloseLogic(openCloseSettings),
       ConnectLogger(std::chrono::minutes(5), "[serial client] ")
@@ -51,10 +53,12 @@ void TSerialClient::AddRegister(PRegister reg)
 {
     if (Active)
         throw TSerialDeviceException("can't add registers to the active client");
-    if (Handlers.find(reg) != Handlers.end())
+    auto index = reg->GetClientIndex();
+    if (index < RegList.size() && RegList[index] == reg)
         throw TSerialDeviceException("duplicate register");
-    auto handler = Handlers[reg] = std::make_shared<TRegisterHandler>(reg->Device(), reg, FlushNeeded);
+    reg->SetClientIndex(RegList.size());
     RegList.push_back(reg);
+    Handlers.push_back(std::make_shared<TRegisterHandler>(reg->Device(), reg, FlushNeeded, FlushQueue));
     LOG(Debug) << "AddRegister: " << reg;
 }
 
@@ -78,15 +82,15 @@ void TSerialClient::PrepareRegisterRanges()
     // all of this is seemingly slow but it's actually only done once
     Plan->Reset();
     PSerialDevice last_device(0);
-    std::list<PRegister> cur_regs;
+    std::vector<PRegister> cur_regs;
     auto it = RegList.begin();
     std::list<PSerialPollEntry> entries;
     std::unordered_map<long long, PSerialPollEntry> interval_map;
     for (;;) {
         bool at_end = it == RegList.end();
         if ((at_end || (*it)->Device() != last_device) && !cur_regs.empty()) {
-            cur_regs.sort([](const PRegister& a, const PRegister& b) {
-                    return a->Type < b->Type || (a->Type == b->Type && a->GetAddress() < b->GetAddress());
+            std::stable_sort(cur_regs.begin(), cur_regs.end(), [](const PRegister& a, const PRegister& b) {
+                    return a->GetConfig()->Type < b->GetConfig()->Type || (a->GetConfig()->Type == b->GetConfig()->Type && a->GetConfig()->GetAddress() < b->GetConfig()->GetAddress());
                 });
             interval_map.clear();
 
@@ -123,17 +127,24 @@ void TSerialClient::MaybeUpdateErrorState(PRegister reg, TRegisterHandler::TErro
 
 void TSerialClient::DoFlush()
 {
-    for (const auto& reg: RegList) {
-        auto handler = Handlers[reg];
-        if (!handler->NeedToFlush())
-            continue;
-        PrepareToAccessDevice(handler->Device());
-        auto flushRes = handler->Flush();
-        if (handler->CurrentErrorState() != TRegisterHandler::WriteError && handler->CurrentErrorState() != TRegisterHandler::ReadWriteError) {
-            ReadCallback(reg, flushRes.ValueIsChanged);
+    FlushQueue->PopAll(PendingFlushes);
+    size_t stillPending = 0;
+    for (auto handler: PendingFlushes) {
+        if (handler->NeedToFlush()) {
+            const auto& reg = handler->Register();
+            PrepareToAccessDevice(handler->Device());
+            auto flushRes = handler->Flush();
+            if (handler->CurrentErrorState() != TRegisterHandler::WriteError && handler->CurrentErrorState() != TRegisterHandler::ReadWriteError) {
+                ReadCallback(reg, flushRes.ValueIsChanged);
+            }
+            MaybeUpdateErrorState(reg, flushRes.Error);
+        }
+        // failed writes are retried on next flush
+        if (handler->KeepInFlushQueue()) {
+            PendingFlushes[stillPending++] = handler;
         }
-        MaybeUpdateErrorState(reg, flushRes.Error);
     }
+    PendingFlushes.resize(stillPending);
 }
 
 void TSerialClient::WaitForPollAndFlush()
@@ -157,12 +168,8 @@ void TSerialClient::WaitForPollAndFlush()
 
 void TSerialClient::UpdateFlushNeeded()
 {
-    for (const auto& reg: RegList) {
-        auto handler = Handlers[reg];
-        if (handler->NeedToFlush()) {
-            FlushNeeded->Signal();
-            break;
-        }
+    if (!PendingFlushes.empty()) {
+        FlushNeeded->Signal();
     }
 }
 
@@ -179,7 +186,7 @@ void TSerialClient::SetReadError(PRegisterRange range)
     for (auto reg: range->RegisterList()) {
         reg->SetError(ST_UNKNOWN_ERROR);
         bool changed;
-        auto handler = Handlers[reg];
+        const auto& handler = GetHandler(reg);
 
         if (handler->NeedToPoll())
             // TBD: separate AcceptDeviceReadError method (changed is unused here)
@@ -187,14 +194,14 @@ void TSerialClient::SetReadError(PRegisterRange range)
     }
 }
 
-std::list<PRegisterRange> TSerialClient::PollRange(PRegisterRange range)
+std::vector<PRegisterRange> TSerialClient::PollRange(PRegisterRange range)
 {
     PSerialDevice dev = range->Device();
     PrepareToAccessDevice(dev);
-    std::list<PRegisterRange> newRanges = dev->ReadRegisterRange(range);
+    std::vector<PRegisterRange> newRanges = dev->ReadRegisterRange(range);
     for (auto& reg: range->RegisterList()) {
         bool changed;
-        auto handler = Handlers[reg];
+        const auto& handler = GetHandler(reg);
         if (reg->GetError()) {
             if (handler->NeedToPoll())
                 // TBD: separate AcceptDeviceReadError method (changed is unused here)
@@ -223,7 +230,7 @@ void TSerialClient::OpenPortCycle()
 
     Plan->ProcessPending([&](const PPollEntry& entry) {
         auto pollEntry = dynamic_cast<TSerialPollEntry*>(entry.get());
-        std::list<PRegisterRange> newRanges;
+        std::vector<PRegisterRange> newRanges;
         for (auto range: pollEntry->Ranges) {
             auto device = range->Device();
             auto & statuses = devicesRangesStatuses[device];
@@ -267,7 +274,8 @@ void TSerialClient::OpenPortCycle()
                 }
             }
             try {
-                newRanges.splice(newRanges.end(), PollRange(range));
+                auto polledRanges = PollRange(range);
+                newRanges.insert(newRanges.end(), std::make_move_iterator(polledRanges.begin()), std::make_move_iterator(polledRanges.end()));
                 statuses.insert(range->GetStatus());
             } catch (const TSerialDeviceException& e) {
                 LOG(Error) << e.what();
@@ -329,11 +337,10 @@ void TSerialClient::ClosedPortCycle()
         p->EndPollCycle();
     }
 
-    for (const auto& reg: RegList) {
-        auto handler = Handlers[reg];
-        if (!handler->NeedToFlush())
-            continue;
-        MaybeUpdateErrorState(reg, handler->Flush(TRegisterHandler::WriteError).Error);
+    // Pending writes can't be done, report errors and keep them until the port is opened
+    FlushQueue->PopAll(PendingFlushes);
+    for (auto handler: PendingFlushes) {
+        MaybeUpdateErrorState(handler->Register(), handler->Flush(TRegisterHandler::WriteError).Error);
     }
 }
 
@@ -352,7 +359,7 @@ void TSerialClient::Cycle()
         OpenPortCycle();
     } else {
         ClosedPortCycle();
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        Port->WaitForOpen(std::chrono::milliseconds(500));
     }
 }
 
@@ -391,12 +398,12 @@ void TSerialClient::NotifyFlushNeeded()
     FlushNeeded->Signal();
 }
 
-PRegisterHandler TSerialClient::GetHandler(PRegister reg) const
+const PRegisterHandler& TSerialClient::GetHandler(const PRegister& reg) const
 {
-    auto it = Handlers.find(reg);
-    if (it == Handlers.end())
+    auto index = reg->GetClientIndex();
+    if (index >= RegList.size() || RegList[index] != reg)
         throw TSerialDeviceException("register not found");
-    return it->second;
+    return Handlers[index];
 }
 
 void TSerialClient::PrepareToAccessDevice(PSerialDevice dev)
@@ -41,9 +41,9 @@ private:
     void DoFlush();
     void WaitForPollAndFlush();
     void MaybeFlushAvoidingPollStarvationButDontWait();
-    std::list<PRegisterRange> PollRange(PRegisterRange range);
+    std::vector<PRegisterRange> PollRange(PRegisterRange range);
     void SetReadError(PRegisterRange range);
-    PRegisterHandler GetHandler(PRegister) const;
+    const PRegisterHandler& GetHandler(const PRegister& reg) const;
     void MaybeUpdateErrorState(PRegister reg, TRegisterHandler::TErrorState state);
     void PrepareToAccessDevice(PSerialDevice dev);
     void OnDeviceReconnect(PSerialDevice dev);
@@ -52,9 +52,9 @@ private:
     void UpdateFlushNeeded();
 
     PPort Port;
-    std::list<PRegister>       RegList;
+    std::vector<PRegister>       RegList; /* indexed by TRegister::GetClientIndex() */
     std::vector<PSerialDevice> Devices; /* for EndPollCycle */
-    std::unordered_map<PRegister, PRegisterHandler> Handlers;
+    std::vector<PRegisterHandler> Handlers; /* parallel to RegList */
 
     bool Active;
     int PollInterval;
@@ -62,6 +62,8 @@ private:
     TErrorCallback ErrorCallback;
     PSerialDevice LastAccessedDevice = 0;
     PBinarySemaphore FlushNeeded;
+    PFlushQueue FlushQueue;
+    std::vector<TRegisterHandler*> PendingFlushes; /* handlers popped from FlushQueue and not written yet */
     PPollPlan Plan;
 
     const int MAX_REGS = 65536;
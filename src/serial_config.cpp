@@ -15,6 +15,7 @@
 
 #include "tcp_port_settings.h"
 #include "tcp_port.h"
+#include "udp_port.h"
 
 #include "serial_port_settings.h"
 #include "serial_port.h"
@@ -461,6 +462,12 @@ namespace {
 
         Get(port_data, "data_bits", settings.DataBits);
         Get(port_data, "stop_bits", settings.StopBits);
+        Get(port_data, "precise_timing", settings.PreciseTiming);
+        Get(port_data, "rs485", settings.Rs485);
+        Get(port_data, "rs485_delay_rts_before_send_ms", settings.Rs485DelayRtsBeforeSend);
+        Get(port_data, "rs485_delay_rts_after_send_ms", settings.Rs485DelayRtsAfterSend);
+        Get(port_data, "low_latency", settings.LowLatency);
+        Get(port_data, "rx_trigger_bytes", settings.RxTriggerBytes);
 
         return std::make_shared<TSerialPortWithIECHack>(std::make_shared<TSerialPort>(settings));
     }
@@ -468,9 +475,24 @@ namespace {
     PPort OpenTcpPort(const Json::Value& port_data)
     {
         TTcpPortSettings settings(port_data["address"].asString(), GetInt(port_data, "port"));
+        Get(port_data, "min_response_lag_ms", settings.MinResponseLag);
+        Get(port_data, "max_response_lag_ms", settings.MaxResponseLag);
+        if (settings.MinResponseLag > settings.MaxResponseLag) {
+            throw TConfigParserException("min_response_lag_ms is greater than max_response_lag_ms");
+        }
+        Get(port_data, "min_frame_lag_ms", settings.MinFrameLag);
+        Get(port_data, "max_frame_lag_ms", settings.MaxFrameLag);
+        if (settings.MinFrameLag > settings.MaxFrameLag) {
+            throw TConfigParserException("min_frame_lag_ms is greater than max_frame_lag_ms");
+        }
         return std::make_shared<TTcpPort>(settings);
     }
 
+    PPort OpenUdpPort(const Json::Value& port_data)
+    {
+        return std::make_shared<TUdpPort>(TUdpPortSettings(port_data["address"].asString(), GetInt(port_data, "port")));
+    }
+
     void LoadPort(PHandlerConfig handlerConfig,
                   const Json::Value& port_data,
                   const std::string& id_prefix,
@@ -481,25 +503,71 @@ namespace {
         if (port_data.isMember("enabled") && !port_data["enabled"].asBool())
             return;
 
-        auto port_config = make_shared<TPortConfig>();
+        auto port_type = port_data.get("port_type", "serial").asString();
 
-        Get(port_data, "response_timeout_ms", port_config->ResponseTimeout);
-        Get(port_data, "poll_interval",       port_config->PollInterval);
-        Get(port_data, "guard_interval_us",   port_config->RequestDelay);
+        // Several connections to the same TCP endpoint, devices are distributed between them
+        // and polled in parallel by separate port drivers
+        int connections = 1;
+        Get(port_data, "connections", connections);
+        if (connections < 1) {
+            throw TConfigParserException("connections must be positive");
+        }
+        if (connections > 1 && port_type != "tcp" && port_type != "modbus tcp") {
+            throw TConfigParserException("multiple connections are supported only by TCP ports");
+        }
 
-        auto port_type = port_data.get("port_type", "serial").asString();
+        std::vector<PPortConfig> port_configs;
+        for (int i = 0; i < connections; ++i) {
+            auto port_config = make_shared<TPortConfig>();
 
-        Get(port_data, "connection_timeout_ms",      port_config->OpenCloseSettings.MaxFailTime);
-        Get(port_data, "connection_max_fail_cycles", port_config->OpenCloseSettings.ConnectionMaxFailCycles);
+            Get(port_data, "response_timeout_ms", port_config->ResponseTimeout);
+            Get(port_data, "poll_interval",       port_config->PollInterval);
+            Get(port_data, "guard_interval_us",   port_config->RequestDelay);
 
-        std::tie(port_config->Port, port_config->IsModbusTcp) = portFactory(port_data);
+            Get(port_data, "connection_timeout_ms",      port_config->OpenCloseSettings.MaxFailTime);
+            Get(port_data, "connection_max_fail_cycles", port_config->OpenCloseSettings.ConnectionMaxFailCycles);
 
+            std::tie(port_config->Port, port_config->IsModbusTcp) = portFactory(port_data, i);
+            port_config->Id = GetPortId(port_config->Port->GetDescription(), i);
+            port_configs.push_back(port_config);
+        }
 
+        // Devices with "connection" parameter are bound to the given connection,
+        // the rest of enabled devices are assigned to connections in turn
+        // in the order they appear in the config.
+        // all_devices is used to find device redefinitions on different connections
+        TPortConfig all_devices;
+        size_t auto_assigned_devices = 0;
         const Json::Value& array = port_data["devices"];
-        for(Json::Value::ArrayIndex index = 0; index < array.size(); ++index)
-            LoadDevice(port_config, array[index], id_prefix + std::to_string(index), templates, deviceFactory);
+        for(Json::Value::ArrayIndex index = 0; index < array.size(); ++index) {
+            const auto& device_data = array[index];
+            bool auto_assigned = !device_data.isMember("connection");
+            size_t connection = auto_assigned_devices % port_configs.size();
+            if (!auto_assigned) {
+                int n = device_data["connection"].asInt();
+                if (n < 0 || n >= connections) {
+                    throw TConfigParserException("connection must be in range [0, " + std::to_string(connections) + ")");
+                }
+                connection = n;
+            }
+            auto& port_config = port_configs[connection];
+            auto devices_count = port_config->Devices.size();
+            LoadDevice(port_config, device_data, id_prefix + std::to_string(index), templates, deviceFactory);
+            if (port_config->Devices.size() != devices_count) {
+                if (auto_assigned) {
+                    ++auto_assigned_devices;
+                }
+                if (port_configs.size() > 1) {
+                    all_devices.AddDevice(port_config->Devices.back());
+                }
+            }
+        }
 
-        handlerConfig->AddPortConfig(port_config);
+        for (const auto& port_config: port_configs) {
+            if (port_config == port_configs.front() || !port_config->Devices.empty()) {
+                handlerConfig->AddPortConfig(port_config);
+            }
+        }
     }
 
     void CheckNesting(const Json::Value& root, size_t nestingLevel, ITemplateMap& templates)
@@ -535,7 +603,7 @@ void SetIfExists(Json::Value& dst, const std::string& dstKey, const Json::Value&
     }
 }
 
-std::pair<PPort, bool> DefaultPortFactory(const Json::Value& port_data)
+std::pair<PPort, bool> DefaultPortFactory(const Json::Value& port_data, size_t connection)
 {
     auto port_type = port_data.get("port_type", "serial").asString();
     if (port_type == "serial") {
@@ -547,9 +615,20 @@ std::pair<PPort, bool> DefaultPortFactory(const Json::Value& port_data)
     if (port_type == "modbus tcp") {
         return {OpenTcpPort(port_data), true};
     }
+    if (port_type == "udp") {
+        return {OpenUdpPort(port_data), false};
+    }
     throw TConfigParserException("invalid port_type: '" + port_type + "'");
 }
 
+std::string GetPortId(const std::string& description, size_t connection)
+{
+    if (connection == 0) {
+        return description;
+    }
+    return description + "#" + std::to_string(connection);
+}
+
 TTemplateMap::TTemplateMap(const std::string& templatesDir, const Json::Value& templateSchema, bool passInvalidTemplates): 
     Validator(new  WBMQTT::JSON::TValidator(templateSchema)) 
 {
@@ -137,6 +137,9 @@ struct TPortConfig
 
     bool IsModbusTcp = false;
 
+    //! Unique id of the port, see GetPortId
+    std::string Id;
+
     void AddDevice(PSerialDevice device);
 };
 
@@ -162,8 +165,21 @@ Json::Value LoadConfigTemplatesSchema(const std::string& templateSchemaFileName,
 void AddFakeDeviceType(Json::Value& configSchema);
 void AddRegisterType(Json::Value& configSchema, const std::string& registerType);
 
-typedef std::function<std::pair<PPort, bool>(const Json::Value& config)> TPortFactoryFn;
-std::pair<PPort, bool> DefaultPortFactory(const Json::Value& port_data);
+/**
+ * @brief Port factory for LoadConfig. Returns the port and true if it is a Modbus TCP port.
+ *        config is the port's JSON config, connection is an index of the connection
+ *        if the port has several connections to the same endpoint (see "connections" port parameter).
+ */
+typedef std::function<std::pair<PPort, bool>(const Json::Value& config, size_t connection)> TPortFactoryFn;
+std::pair<PPort, bool> DefaultPortFactory(const Json::Value& port_data, size_t connection);
+
+/**
+ * @brief Get unique id of a port config.
+ *        It is the port description for the first connection to an endpoint and
+ *        the description with "#<connection>" suffix for additional ones.
+ *        The id binds captured traffic to ports in replay mode.
+ */
+std::string GetPortId(const std::string& description, size_t connection);
 
 Json::Value LoadConfigSchema(const std::string& schemaFileName);
 
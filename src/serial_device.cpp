@@ -62,9 +62,9 @@ std::string TSerialDevice::ToString() const
     return Protocol()->GetName() + ":" + DeviceConfig()->SlaveId;
 }
 
-std::list<PRegisterRange> TSerialDevice::SplitRegisterList(const std::list<PRegister> & reg_list, bool) const
+std::vector<PRegisterRange> TSerialDevice::SplitRegisterList(const std::vector<PRegister> & reg_list, bool) const
 {
-    std::list<PRegisterRange> r;
+    std::vector<PRegisterRange> r;
     for (auto reg: reg_list)
         r.push_back(std::make_shared<TSimpleRegisterRange>(reg));
     return r;
@@ -83,7 +83,7 @@ uint64_t TSerialDevice::ReadRegister(PRegister reg)
     throw TSerialDeviceException("single register reading is not supported");
 }
 
-std::list<PRegisterRange> TSerialDevice::ReadRegisterRange(PRegisterRange range)
+std::vector<PRegisterRange> TSerialDevice::ReadRegisterRange(PRegisterRange range)
 {
     PSimpleRegisterRange simple_range = std::dynamic_pointer_cast<TSimpleRegisterRange>(range);
     if (!simple_range)
@@ -111,7 +111,7 @@ std::list<PRegisterRange> TSerialDevice::ReadRegisterRange(PRegisterRange range)
                   << reg->Device()->ToString() + "] Register " << reg->ToString() << " is now marked as unsupported";
         }
     }
-    return std::list<PRegisterRange>{range};
+    return std::vector<PRegisterRange>{range};
 }
 
 void TSerialDevice::OnCycleEnd(bool ok)
@@ -142,6 +142,23 @@ void TSerialDevice::OnCycleEnd(bool ok)
     }
 }
 
+PRegister TSerialDevice::GetRegister(PRegisterConfig config)
+{
+    auto it = RegisterIds.find(config.get());
+    if (it != RegisterIds.end()) {
+        return Registers[it->second];
+    }
+    uint32_t id = Registers.size();
+    Registers.push_back(std::make_shared<TRegister>(shared_from_this(), config, id));
+    RegisterIds.emplace(config.get(), id);
+    return Registers.back();
+}
+
+const std::vector<PRegister>& TSerialDevice::GetRegisters() const
+{
+    return Registers;
+}
+
 bool TSerialDevice::GetIsDisconnected() const
 {
 	return IsDisconnected;
@@ -156,7 +156,7 @@ public:
     TSerialDevice(const TSerialDevice&) = delete;
     TSerialDevice& operator=(const TSerialDevice&) = delete;
     virtual ~TSerialDevice();
-    virtual std::list<PRegisterRange> SplitRegisterList(const std::list<PRegister> & reg_list, bool enableHoles = true) const;
+    virtual std::vector<PRegisterRange> SplitRegisterList(const std::vector<PRegister> & reg_list, bool enableHoles = true) const;
 
     // Prepare to access device (pauses for configured delay by default)
     // i.e. "StartSession". Called before any read/write/etc after communicating with another device
@@ -170,7 +170,7 @@ public:
     // Handle end of poll cycle e.g. by resetting values caches
     virtual void EndPollCycle();
     // Read multiple registers
-    virtual std::list<PRegisterRange> ReadRegisterRange(PRegisterRange range);
+    virtual std::vector<PRegisterRange> ReadRegisterRange(PRegisterRange range);
 
     virtual std::string ToString() const;
 
@@ -183,6 +183,16 @@ public:
     PDeviceConfig DeviceConfig() const { return _DeviceConfig; }
     PProtocol Protocol() const { return _Protocol; }
 
+    /**
+     * @brief Get device's register for the config.
+     *        The register is created and added to device's register table on first call.
+     *        Not thread-safe, registers must be created before polling starts.
+     */
+    PRegister GetRegister(PRegisterConfig config);
+
+    //! Device's register table. Index in the table is TRegister::GetId()
+    const std::vector<PRegister>& GetRegisters() const;
+
     virtual void OnCycleEnd(bool ok);
     bool GetIsDisconnected() const;
 
@@ -206,6 +216,8 @@ private:
     PPort SerialPort;
     PDeviceConfig _DeviceConfig;
     PProtocol _Protocol;
+    std::vector<PRegister> Registers;
+    std::unordered_map<const TRegisterConfig*, uint32_t> RegisterIds;
     std::chrono::steady_clock::time_point LastSuccessfulCycle;
     bool IsDisconnected;
     int RemainingFailCycles;
@@ -12,8 +12,14 @@ using namespace WBMQTT;
 
 #define LOG(logger) ::logger.Log() << "[serial] "
 
-TMQTTSerialDriver::TMQTTSerialDriver(PDeviceDriver mqttDriver, PHandlerConfig config)
-    : Active(false)
+namespace
+{
+    const auto FrameTraceDumpInterval = chrono::milliseconds(100);
+}
+
+TMQTTSerialDriver::TMQTTSerialDriver(PDeviceDriver mqttDriver, PHandlerConfig config, PFrameCaptureWriter frameCapture)
+    : Active(false),
+      FrameCapture(frameCapture)
 {
     try {
         for (const auto& portConfig : config->PortConfigs) {
@@ -25,6 +31,14 @@ TMQTTSerialDriver::TMQTTSerialDriver(PDeviceDriver mqttDriver, PHandlerConfig co
 
             PortDrivers.push_back(make_shared<TSerialPortDriver>(mqttDriver, portConfig, config->PublishParameters));
             PortDrivers.back()->SetUpDevices();
+
+            auto trace = portConfig->Port->GetFrameTrace();
+            if (trace && (::Debug.IsEnabled() || FrameCapture)) {
+                trace->SetEnabled(true);
+                auto description = portConfig->Port->GetDescription();
+                uint8_t capturePort = FrameCapture ? FrameCapture->AddPort(portConfig->Id) : 0;
+                FrameTraces.push_back({description, trace, capturePort});
+            }
         }
     } catch (const exception & e) {
         LOG(Error) << "unable to create port driver: '" << e.what() << "'. Cleaning.";
@@ -43,6 +57,31 @@ void TMQTTSerialDriver::LoopOnce()
 {
     for (const auto & portDriver: PortDrivers)
         portDriver->Cycle();
+    DumpFrameTraces();
+}
+
+void TMQTTSerialDriver::DumpFrameTraces()
+{
+    TFrameTraceRecord record;
+    for (const auto& trace: FrameTraces) {
+        while (trace.Trace->Pop(record)) {
+            if (::Debug.IsEnabled()) {
+                LOG(Debug) << trace.Description << ": " << FormatFrameTraceRecord(record);
+            }
+            if (FrameCapture) {
+                try {
+                    FrameCapture->Write(trace.CapturePort, record);
+                } catch (const exception& e) {
+                    LOG(Error) << "frame capture is stopped: " << e.what();
+                    FrameCapture.reset();
+                }
+            }
+        }
+        auto dropped = trace.Trace->TakeDropped();
+        if (dropped) {
+            LOG(Warn) << trace.Description << ": " << dropped << " frame(s) are missing in trace";
+        }
+    }
 }
 
 void TMQTTSerialDriver::ClearDevices()
@@ -71,6 +110,16 @@ void TMQTTSerialDriver::Start()
             }
         });
     }
+
+    if (!FrameTraces.empty()) {
+        FrameTraceLoop = std::thread([this]{
+            WBMQTT::SetThreadName("frame trace");
+            while (Active) {
+                std::this_thread::sleep_for(FrameTraceDumpInterval);
+                DumpFrameTraces();
+            }
+        });
+    }
 }
 
 void TMQTTSerialDriver::Stop()
@@ -90,5 +139,10 @@ void TMQTTSerialDriver::Stop()
         }
     }
 
+    if (FrameTraceLoop.joinable()) {
+        FrameTraceLoop.join();
+    }
+    DumpFrameTraces();
+
     ClearDevices();
 }
@@ -2,6 +2,7 @@
 
 #include "serial_config.h"
 #include "serial_port_driver.h"
+#include "frame_capture.h"
 
 #include <wblib/declarations.h>
 
@@ -13,7 +14,14 @@
 class TMQTTSerialDriver
 {
 public:
-    TMQTTSerialDriver(WBMQTT::PDeviceDriver mqtt_driver, PHandlerConfig handler_config);
+    /**
+     * @brief Construct a new TMQTTSerialDriver object
+     *
+     * @param frame_capture if not null, traffic of all ports is written to it
+     */
+    TMQTTSerialDriver(WBMQTT::PDeviceDriver mqtt_driver,
+                      PHandlerConfig        handler_config,
+                      PFrameCaptureWriter   frame_capture = nullptr);
     void LoopOnce();
     void ClearDevices();
 
@@ -21,10 +29,24 @@ public:
     void Stop();
 
 private:
+    struct TPortFrameTrace
+    {
+        std::string Description;
+        PFrameTrace Trace;
+        uint8_t     CapturePort;
+    };
+
+    //! Log and capture traffic collected by ports since last call
+    void DumpFrameTraces();
+
     std::vector<PSerialPortDriver> PortDrivers;
     std::vector<std::thread>       PortLoops;
     std::mutex                     ActiveMutex;
     bool                           Active;
+
+    std::vector<TPortFrameTrace> FrameTraces;
+    std::thread                  FrameTraceLoop;
+    PFrameCaptureWriter          FrameCapture;
 };
 
 typedef std::shared_ptr<TMQTTSerialDriver> PMQTTSerialDriver;
@@ -2,6 +2,7 @@
 #include "serial_port.h"
 #include "log.h"
 #include "iec_common.h"
+#include "serial_port_baud_rate.h"
 
 #include <string.h>
 #include <fcntl.h>
@@ -9,9 +10,13 @@
 #include <utility>
 #include <cmath>
 #include <iomanip>
+#include <fstream>
+#include <climits>
+#include <stdlib.h>
 #include <unistd.h>
+#include <thread>
+#include <algorithm>
 
-#include <linux/serial.h>
 #include <sys/ioctl.h>
 
 #define LOG(logger) ::logger.Log() << "[serial port] "
@@ -19,23 +24,51 @@
 using namespace WBMQTT;
 
 namespace {
-    int ConvertBaudRate(int rate)
+    // Default extra time for frame timeout, it covers tty layer buffering
+    const std::chrono::microseconds DefaultFrameTimeoutLag = std::chrono::milliseconds(15);
+    const std::chrono::microseconds MinFrameTimeoutLag = std::chrono::milliseconds(1);
+
+    // Max deviation of actual baud rate from requested one. Most UARTs tolerate up to 2-3%
+    const double MAX_BAUD_RATE_DEVIATION = 0.02;
+
+    // Min interval between line status register reads while waiting for transmission end
+    const std::chrono::microseconds LSR_MIN_POLL_INTERVAL(50);
+
+    //! Convert baud rate to termios speed constant, returns B0 for non-standard rates
+    speed_t ConvertBaudRate(int rate)
     {
         switch (rate) {
-        case 110:   return B110;
-        case 300:   return B300;
-        case 600:   return B600;
-        case 1200:  return B1200;
-        case 2400:  return B2400;
-        case 4800:  return B4800;
-        case 9600:  return B9600;
-        case 19200: return B19200;
-        case 38400: return B38400;
-        case 57600: return B57600;
-        case 115200: return B115200;
-        default:
-            LOG(Warn) << "unsupported baud rate " << rate << " defaulting to 9600";
-            return B9600;
+        case 50:      return B50;
+        case 75:      return B75;
+        case 110:     return B110;
+        case 134:     return B134;
+        case 150:     return B150;
+        case 200:     return B200;
+        case 300:     return B300;
+        case 600:     return B600;
+        case 1200:    return B1200;
+        case 1800:    return B1800;
+        case 2400:    return B2400;
+        case 4800:    return B4800;
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 500000:  return B500000;
+        case 576000:  return B576000;
+        case 921600:  return B921600;
+        case 1000000: return B1000000;
+        case 1152000: return B1152000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        case 2500000: return B2500000;
+        case 3000000: return B3000000;
+        case 3500000: return B3500000;
+        case 4000000: return B4000000;
+        default:      return B0;
         }
     }
 
@@ -54,18 +87,30 @@ namespace {
 
     std::chrono::milliseconds GetLinuxLag(int baudRate)
     {
-        return std::chrono::milliseconds(baudRate < 9600 ? 34 : 24);
+        if (baudRate < 9600) {
+            return std::chrono::milliseconds(34);
+        }
+        if (baudRate <= 115200) {
+            return std::chrono::milliseconds(24);
+        }
+        // UART FIFO trigger level is reached in less than a millisecond at high speeds,
+        // so only tty layer and scheduling latency remain
+        return std::chrono::milliseconds(12);
     }
 };
 
 TSerialPort::TSerialPort(const TSerialPortSettings& settings)
-    : Settings(settings)
+    : Settings(settings),
+      BaudRate(settings.BaudRate),
+      DeliveryJitter(DefaultFrameTimeoutLag / 2)
 {
     memset(&OldTermios, 0, sizeof(termios));
+    memset(&OldRs485, 0, sizeof(serial_rs485));
 }
 
 void TSerialPort::Open()
 {
+    bool termiosChanged = false;
     try {
         if (IsOpen())
             throw std::runtime_error("port is already open");
@@ -74,9 +119,18 @@ void TSerialPort::Open()
         if (Fd < 0)
             throw std::runtime_error("can't open serial port");
 
+        if (Settings.BaudRate <= 0) {
+            throw std::runtime_error("invalid baud rate " + std::to_string(Settings.BaudRate));
+        }
+
         termios dev;
         memset(&dev, 0, sizeof(termios));
         auto baud_rate = ConvertBaudRate(Settings.BaudRate);
+        bool customBaudRate = (baud_rate == B0);
+        if (customBaudRate) {
+            // the exact rate is set by SetCustomBaudRate after applying other attributes
+            baud_rate = B9600;
+        }
         if (cfsetospeed(&dev, baud_rate) != 0 || cfsetispeed(&dev, baud_rate) != 0) {
             throw std::runtime_error("can't set baud rate " + std::to_string(Settings.BaudRate) + " " + FormatErrno(errno));
         }
@@ -127,38 +181,171 @@ void TSerialPort::Open()
         if (tcsetattr (Fd, TCSANOW, &dev) != 0) {
             throw std::runtime_error("can't set termios attributes" + FormatErrno(errno));
         }
+        termiosChanged = true;
+
+        SetupDriver();
+
+        if (customBaudRate) {
+            auto actualBaudRate = SetCustomBaudRate(Fd, Settings.BaudRate);
+            if (std::fabs(actualBaudRate - Settings.BaudRate) > MAX_BAUD_RATE_DEVIATION * Settings.BaudRate) {
+                LOG(Warn) << Settings.Device << ": baud rate " << Settings.BaudRate << " is not supported precisely, actual rate is " << actualBaudRate;
+            }
+        }
     } catch (const std::runtime_error& e) {
         if (Fd >= 0) {
+            // Don't leave the tty reconfigured if setup has failed halfway
+            RestoreDriverSettings();
+            if (termiosChanged) {
+                tcsetattr(Fd, TCSANOW, &OldTermios);
+            }
             close(Fd);
             Fd = -1;
         }
         throw TSerialDeviceException(Settings.Device + ", " + e.what());
     }
+    BaudRate = Settings.BaudRate;
     LastInteraction = std::chrono::steady_clock::now();
     SkipNoise();    // flush data from previous instance if any
 }
 
+void TSerialPort::SetupDriver()
+{
+    if (Settings.Rs485) {
+        serial_rs485 rs485;
+        if (ioctl(Fd, TIOCGRS485, &OldRs485) < 0) {
+            LOG(Warn) << Settings.Device << ": kernel RS-485 mode is not supported " << FormatErrno(errno);
+        } else {
+            rs485 = OldRs485;
+            // RTS is active while sending and inactive after, so the transmitter is enabled only during sending
+            rs485.flags |= SER_RS485_ENABLED | SER_RS485_RTS_ON_SEND;
+            rs485.flags &= ~(SER_RS485_RTS_AFTER_SEND | SER_RS485_RX_DURING_TX);
+            rs485.delay_rts_before_send = Settings.Rs485DelayRtsBeforeSend.count();
+            rs485.delay_rts_after_send = Settings.Rs485DelayRtsAfterSend.count();
+            if (ioctl(Fd, TIOCSRS485, &rs485) < 0) {
+                LOG(Warn) << Settings.Device << ": can't enable kernel RS-485 mode " << FormatErrno(errno);
+            } else {
+                Rs485Changed = true;
+            }
+        }
+    }
+
+    if (Settings.LowLatency) {
+        serial_struct serial;
+        if (ioctl(Fd, TIOCGSERIAL, &serial) < 0) {
+            LOG(Warn) << Settings.Device << ": low latency mode is not supported " << FormatErrno(errno);
+        } else if (!(serial.flags & ASYNC_LOW_LATENCY)) {
+            serial.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(Fd, TIOCSSERIAL, &serial) < 0) {
+                LOG(Warn) << Settings.Device << ": can't enable low latency mode " << FormatErrno(errno);
+            } else {
+                LowLatencyChanged = true;
+            }
+        }
+    }
+
+    if (Settings.RxTriggerBytes > 0) {
+        SetRxTriggerBytes();
+    }
+}
+
+void TSerialPort::SetRxTriggerBytes()
+{
+    // 8250 compatible UARTs expose FIFO trigger level through sysfs only
+    char path[PATH_MAX];
+    if (!realpath(Settings.Device.c_str(), path)) {
+        LOG(Warn) << Settings.Device << ": can't resolve device path " << FormatErrno(errno);
+        return;
+    }
+    auto name = strrchr(path, '/');
+    std::string triggerFile = std::string("/sys/class/tty") + (name ? name : path) + "/rx_trig_bytes";
+    std::string oldValue;
+    {
+        std::ifstream in(triggerFile);
+        std::getline(in, oldValue);
+    }
+    std::ofstream f(triggerFile);
+    if (!f.is_open()) {
+        LOG(Warn) << Settings.Device << ": FIFO trigger level setup is not supported";
+        return;
+    }
+    f << Settings.RxTriggerBytes;
+    f.close();
+    if (f.fail()) {
+        LOG(Warn) << Settings.Device << ": can't set FIFO trigger level " << Settings.RxTriggerBytes;
+    } else if (!oldValue.empty()) {
+        RxTriggerFile = triggerFile;
+        OldRxTriggerBytes = oldValue;
+    }
+}
+
+void TSerialPort::RestoreDriverSettings()
+{
+    if (Rs485Changed) {
+        ioctl(Fd, TIOCSRS485, &OldRs485);
+        Rs485Changed = false;
+    }
+    if (LowLatencyChanged) {
+        serial_struct serial;
+        if (ioctl(Fd, TIOCGSERIAL, &serial) == 0) {
+            serial.flags &= ~ASYNC_LOW_LATENCY;
+            ioctl(Fd, TIOCSSERIAL, &serial);
+        }
+        LowLatencyChanged = false;
+    }
+    if (!RxTriggerFile.empty()) {
+        std::ofstream f(RxTriggerFile);
+        f << OldRxTriggerBytes;
+        RxTriggerFile.clear();
+    }
+}
+
 void TSerialPort::Close()
 {
     if (Base::IsOpen()) {
+        RestoreDriverSettings();
         tcsetattr(Fd, TCSANOW, &OldTermios);
     }
     Base::Close();
 }
 
-std::chrono::milliseconds TSerialPort::GetSendTime(double bytesNumber)
+std::chrono::microseconds TSerialPort::GetSendTimeUs(double bytesNumber) const
 {
     size_t bitsPerByte = 1 + Settings.DataBits + Settings.StopBits;
     if (Settings.Parity != 'N') {
         ++bitsPerByte;
     }
-    auto ms = std::ceil((1000.0*bitsPerByte*bytesNumber)/double(Settings.BaudRate));
-    return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(ms));
+    auto us = std::ceil((1000000.0*bitsPerByte*bytesNumber)/double(BaudRate));
+    return std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(us));
+}
+
+std::chrono::milliseconds TSerialPort::GetSendTime(double bytesNumber)
+{
+    auto us = GetSendTimeUs(bytesNumber).count();
+    return std::chrono::milliseconds((us + 999) / 1000);
+}
+
+std::chrono::microseconds TSerialPort::GetFrameTimeoutLag() const
+{
+    if (!Settings.PreciseTiming) {
+        return DefaultFrameTimeoutLag;
+    }
+    // Double the jitter for safety margin
+    return std::max(MinFrameTimeoutLag, std::min(DefaultFrameTimeoutLag, DeliveryJitter * 2));
+}
+
+void TSerialPort::UpdateFrameTimeoutLag(const std::chrono::microseconds& deliveryJitter)
+{
+    // Keep peaks and forget them slowly, a single fast frame must not shrink the timeout
+    if (deliveryJitter > DeliveryJitter) {
+        DeliveryJitter = deliveryJitter;
+    } else {
+        DeliveryJitter = (DeliveryJitter * 15 + deliveryJitter) / 16;
+    }
 }
 
 uint8_t TSerialPort::ReadByte(const std::chrono::microseconds& timeout)
 {
-    return Base::ReadByte(timeout + GetLinuxLag(Settings.BaudRate));
+    return Base::ReadByte(timeout + GetLinuxLag(BaudRate));
 }
 
 size_t TSerialPort::ReadFrame(uint8_t* buf,
@@ -167,17 +354,78 @@ size_t TSerialPort::ReadFrame(uint8_t* buf,
                            const std::chrono::microseconds& frameTimeout,
                            TFrameCompletePred frameComplete)
 {
+    if (!Settings.PreciseTiming) {
+        return Base::ReadFrame(buf,
+                               count,
+                               responseTimeout + GetLinuxLag(BaudRate),
+                               frameTimeout + DefaultFrameTimeoutLag,
+                               frameComplete);
+    }
+
+    // Data is delivered by chunks. A gap between chunks longer than wire time of the later chunk
+    // is a delay of tty layer, frame timeout must cover it
+    size_t lastSize = 0;
+    auto lastChunkTime = std::chrono::steady_clock::now();
+    auto measuringFrameComplete = [&](uint8_t* buf, size_t size) {
+        if (size != lastSize) {
+            auto now = std::chrono::steady_clock::now();
+            if (lastSize != 0) {
+                auto gap = std::chrono::duration_cast<std::chrono::microseconds>(now - lastChunkTime);
+                UpdateFrameTimeoutLag(std::max(std::chrono::microseconds::zero(), gap - GetSendTimeUs(size - lastSize)));
+            }
+            lastSize = size;
+            lastChunkTime = now;
+        }
+        return frameComplete && frameComplete(buf, size);
+    };
     return Base::ReadFrame(buf,
                            count,
-                           responseTimeout + GetLinuxLag(Settings.BaudRate),
-                           frameTimeout + std::chrono::milliseconds(15),
-                           frameComplete);
+                           responseTimeout + GetLinuxLag(BaudRate),
+                           std::max(frameTimeout, GetSendTimeUs(3.5)) + GetFrameTimeoutLag(),
+                           measuringFrameComplete);
+}
+
+bool TSerialPort::WaitForTransmitComplete()
+{
+    if (tcdrain(Fd) != 0) {
+        LOG(Debug) << Settings.Device << ": tcdrain failed " << FormatErrno(errno);
+        return false;
+    }
+
+    // tcdrain can return when the driver's buffer is empty, but the last byte
+    // is still in UART shift register. Line status register tells when it is sent.
+    // The line status register is polled with short sleeps to not load CPU during the wait
+    if (LsrSupported) {
+        auto deadline = std::chrono::steady_clock::now() + GetSendTimeUs(2);
+        auto pollInterval = std::max(GetSendTimeUs(0.2), LSR_MIN_POLL_INTERVAL);
+        unsigned int lsr = 0;
+        for (;;) {
+            if (ioctl(Fd, TIOCSERGETLSR, &lsr) != 0) {
+                LOG(Debug) << Settings.Device << ": TIOCSERGETLSR is not supported";
+                LsrSupported = false;
+                break;
+            }
+            if (lsr & TIOCSER_TEMT) {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                // Transmitter hasn't reported it is empty, let the caller wait for computed send time
+                return false;
+            }
+            std::this_thread::sleep_for(pollInterval);
+        }
+    }
+    std::this_thread::sleep_for(GetSendTimeUs(1));
+    return true;
 }
 
 void TSerialPort::WriteBytes(const uint8_t* buf, int count)
 {
     Base::WriteBytes(buf, count);
-    SleepSinceLastInteraction(GetSendTime(count));
+    if (!Settings.PreciseTiming || !WaitForTransmitComplete()) {
+        // Microsecond precision matters at high baud rates where a whole frame takes less than 1 ms
+        SleepSinceLastInteraction(GetSendTimeUs(count));
+    }
     LastInteraction = std::chrono::steady_clock::now();
 }
 
@@ -194,7 +442,39 @@ const TSerialPortSettings& TSerialPort::GetSettings() const
     return Settings;
 }
 
-TSerialPortWithIECHack::TSerialPortWithIECHack(PSerialPort port): Port(port), UseIECHack(false)
+bool TSerialPort::SetBaudRate(int baudRate)
+{
+    if (baudRate == 0) {
+        baudRate = Settings.BaudRate;
+    }
+    if (baudRate == BaudRate) {
+        return true;
+    }
+    CheckPortOpen();
+    try {
+        // termios2 is used for standard rates too. Otherwise input speed bits (CIBAUD) left
+        // by a previous custom rate would keep BOTHER and input speed would stay custom.
+        // SetCustomBaudRate applies the rate immediately, so transmission must be finished before
+        tcdrain(Fd);
+        auto actualBaudRate = SetCustomBaudRate(Fd, baudRate);
+        if (std::fabs(actualBaudRate - baudRate) > MAX_BAUD_RATE_DEVIATION * baudRate) {
+            LOG(Warn) << Settings.Device << ": baud rate " << baudRate << " is not supported precisely, actual rate is " << actualBaudRate;
+        }
+    } catch (const std::runtime_error& e) {
+        throw TSerialDeviceException(Settings.Device + ", " + e.what());
+    }
+    BaudRate = baudRate;
+    LOG(Debug) << Settings.Device << ": baud rate is changed to " << BaudRate;
+    return true;
+}
+
+TSerialPortWithIECHack::TSerialPortWithIECHack(PSerialPort port): TSerialPortWithIECHack(port, port->GetSettings())
+{}
+
+TSerialPortWithIECHack::TSerialPortWithIECHack(PPort port, const TSerialPortSettings& settings)
+    : Port(port),
+      Settings(settings),
+      UseIECHack(false)
 {}
 
 void TSerialPortWithIECHack::Open()
@@ -305,16 +585,31 @@ void TSerialPortWithIECHack::SetSerialPortByteFormat(const TSerialPortByteFormat
         return;
     }
 
-    if (   Port->GetSettings().DataBits == 8 && Port->GetSettings().Parity == 'N' && Port->GetSettings().StopBits == 1
+    if (   Settings.DataBits == 8 && Settings.Parity == 'N' && Settings.StopBits == 1
         && params->DataBits == 7 && params->Parity == 'E' && params->StopBits == 1) {
         UseIECHack = true;
         return;
     }
 
-    if (   Port->GetSettings().DataBits == 7 && Port->GetSettings().Parity == 'E' && Port->GetSettings().StopBits == 1
+    if (   Settings.DataBits == 7 && Settings.Parity == 'E' && Settings.StopBits == 1
         && params->DataBits == 7 && params->Parity == 'E' && params->StopBits == 1) {
         UseIECHack = false;
         return;
     }
-    throw std::runtime_error("Can't change " + Port->GetSettings().ToString() + " byte format. Set port settings to 8N1, please");
+    throw std::runtime_error("Can't change " + Settings.ToString() + " byte format. Set port settings to 8N1, please");
+}
+
+bool TSerialPortWithIECHack::SetBaudRate(int baudRate)
+{
+    return Port->SetBaudRate(baudRate);
+}
+
+PFrameTrace TSerialPortWithIECHack::GetFrameTrace() const
+{
+    return Port->GetFrameTrace();
+}
+
+const TSerialPortSettings& TSerialPortWithIECHack::GetSettings() const
+{
+    return Settings;
 }
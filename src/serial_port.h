@@ -1,6 +1,7 @@
 #pragma once
 #include <chrono>
 #include <termios.h>
+#include <linux/serial.h>
 
 #include "file_descriptor_port.h"
 #include "serial_port_settings.h"
@@ -31,18 +32,62 @@ public:
 
     const TSerialPortSettings& GetSettings() const;
 
+    bool SetBaudRate(int baudRate) override;
+
 private:
-    TSerialPortSettings Settings;
-    termios             OldTermios;
+    std::chrono::microseconds GetSendTimeUs(double bytesNumber) const;
+
+    /**
+     * @brief Wait until the last bit of written data leaves UART.
+     *        After tcdrain the transmitter empty flag is polled with TIOCSERGETLSR.
+     *        If the driver doesn't support TIOCSERGETLSR, sleeps for one byte send time instead.
+     *
+     * @return true if the transmitter reported it is empty or after the sleep,
+     *         false if tcdrain failed or the transmitter wasn't empty within two bytes send time.
+     *         On false the caller should wait for computed send time of written data.
+     */
+    bool WaitForTransmitComplete();
+
+    //! Extra time added to frame timeout to cover delays of data delivery through tty layer
+    std::chrono::microseconds GetFrameTimeoutLag() const;
+    void UpdateFrameTimeoutLag(const std::chrono::microseconds& deliveryJitter);
+
+    /**
+     * @brief Configure RS-485 mode, low latency mode and FIFO trigger level if set in settings.
+     *        Unsupported features are reported to log, the port stays usable without them.
+     */
+    void SetupDriver();
+    void RestoreDriverSettings();
+    void SetRxTriggerBytes();
+
+    TSerialPortSettings       Settings;
+    int                       BaudRate; // Current baud rate, can differ from Settings.BaudRate after SetBaudRate
+    termios                   OldTermios;
+    serial_rs485              OldRs485;
+    bool                      Rs485Changed = false;
+    bool                      LowLatencyChanged = false;
+    std::string               RxTriggerFile;
+    std::string               OldRxTriggerBytes;
+    bool                      LsrSupported = true;
+    std::chrono::microseconds DeliveryJitter;
 };
 
 using PSerialPort = std::shared_ptr<TSerialPort>;
 
 class TSerialPortWithIECHack: public TPort
 {
-    PSerialPort Port;
+    PPort               Port;
+    TSerialPortSettings Settings;
 public:
     TSerialPortWithIECHack(PSerialPort port);
+
+    /**
+     * @brief Wrap a port emulating a serial port, e.g. replay of captured traffic
+     *
+     * @param port wrapped port
+     * @param settings settings of the emulated serial port
+     */
+    TSerialPortWithIECHack(PPort port, const TSerialPortSettings& settings);
     ~TSerialPortWithIECHack() = default;
 
     void Open() override;
@@ -73,6 +118,12 @@ public:
 
     void SetSerialPortByteFormat(const TSerialPortByteFormat* params) override;
 
+    bool SetBaudRate(int baudRate) override;
+
+    PFrameTrace GetFrameTrace() const override;
+
+    const TSerialPortSettings& GetSettings() const;
+
 private:
     //! Use 7E to 8N conversion. The workaround allows using IEC devices and other devices on the same bus.
     bool UseIECHack;
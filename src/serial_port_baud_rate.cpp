@@ -0,0 +1,27 @@
+#include "serial_port_baud_rate.h"
+#include "serial_exc.h"
+
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+
+int SetCustomBaudRate(int fd, int baudRate)
+{
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0) {
+        throw std::runtime_error("can't get termios2 attributes " + FormatErrno(errno));
+    }
+
+    tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = baudRate;
+    tio.c_ospeed = baudRate;
+    if (ioctl(fd, TCSETS2, &tio) != 0) {
+        throw std::runtime_error("can't set baud rate " + std::to_string(baudRate) + " " + FormatErrno(errno));
+    }
+
+    if (ioctl(fd, TCGETS2, &tio) != 0) {
+        throw std::runtime_error("can't get termios2 attributes " + FormatErrno(errno));
+    }
+    return tio.c_ospeed;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/**
+ * @brief Set arbitrary baud rate of an open tty using termios2 and BOTHER.
+ *        Both output and input speeds are set, so it works for standard rates too.
+ *        Other termios settings of the tty are left untouched.
+ *        <asm/termbits.h> can't be included together with <termios.h>,
+ *        so the function lives in a separate translation unit.
+ *
+ * @return baud rate actually selected by the driver, it can differ from requested one
+ *         because of UART clock divider rounding
+ *
+ * @throw std::runtime_error if the driver doesn't accept the rate
+ */
+int SetCustomBaudRate(int fd, int baudRate);
@@ -56,8 +56,12 @@ void TSerialPortDriver::SetUpDevices()
                     auto channel = std::make_shared<TDeviceChannel>(device, channelConfig);
                     channel->Control = mqttDevice->CreateControl(tx, From(channel)).GetValue();
                     for (auto & reg: channel->Registers) {
-                        RegisterToChannelStateMap.emplace(reg, TDeviceChannelState{channel, TRegisterHandler::UnknownErrorState});
                         SerialClient->AddRegister(reg);
+                        auto index = reg->GetClientIndex();
+                        if (index >= ChannelStates.size()) {
+                            ChannelStates.resize(index + 1);
+                        }
+                        ChannelStates[index] = TDeviceChannelState{channel, TRegisterHandler::UnknownErrorState};
                     }
                 } catch (const exception & e) {
                     LOG(Error) << "unable to create control: '" << e.what() << "'";
@@ -130,14 +134,22 @@ void TSerialPortDriver::SetValueToChannel(const PDeviceChannel & channel, const
     }
 }
 
+TDeviceChannelState* TSerialPortDriver::GetChannelState(const PRegister& reg)
+{
+    auto index = reg->GetClientIndex();
+    if (index >= ChannelStates.size() || !ChannelStates[index].Channel)
+        return nullptr;
+    return &ChannelStates[index];
+}
+
 void TSerialPortDriver::OnValueRead(PRegister reg, bool changed)
 {
-    auto it = RegisterToChannelStateMap.find(reg);
-    if (it == RegisterToChannelStateMap.end()) {
+    auto state = GetChannelState(reg);
+    if (!state) {
         LOG(Warn) << "got unexpected register from serial client";
         return;
     }
-    const auto & channel = it->second.Channel;
+    const auto & channel = state->Channel;
     const auto & registers = channel->Registers;
 
     if (changed && ::Debug.IsEnabled()) {
@@ -166,25 +178,25 @@ void TSerialPortDriver::OnValueRead(PRegister reg, bool changed)
     channel->UpdateValue(*MqttDriver, PublishPolicy, value);
 }
 
-TRegisterHandler::TErrorState TSerialPortDriver::RegErrorState(PRegister reg)
+TRegisterHandler::TErrorState TSerialPortDriver::RegErrorState(const PRegister& reg)
 {
-    auto it = RegisterToChannelStateMap.find(reg);
-    if (it == RegisterToChannelStateMap.end())
+    auto state = GetChannelState(reg);
+    if (!state)
         return TRegisterHandler::UnknownErrorState;
-    return it->second.ErrorState;
+    return state->ErrorState;
 }
 
 void TSerialPortDriver::UpdateError(PRegister reg, TRegisterHandler::TErrorState errorState)
 {
-    auto it = RegisterToChannelStateMap.find(reg);
-    if (it == RegisterToChannelStateMap.end()) {
+    auto state = GetChannelState(reg);
+    if (!state) {
         LOG(Warn) << "got unexpected register from serial client";
         return;
     }
-    const auto & channel = it->second.Channel;
+    const auto & channel = state->Channel;
     const auto & registers = channel->Registers;
 
-    it->second.ErrorState = errorState;
+    state->ErrorState = errorState;
     size_t errorMask = 0;
     for (auto r: registers) {
         auto error = RegErrorState(r);
@@ -53,13 +53,15 @@ typedef std::shared_ptr<TDeviceChannel> PDeviceChannel;
 
 struct TDeviceChannelState
 {
+    TDeviceChannelState() = default;
+
     TDeviceChannelState(const PDeviceChannel & channel, TRegisterHandler::TErrorState error)
         : Channel(channel)
         , ErrorState(error)
     {}
 
     PDeviceChannel                  Channel;
-    TRegisterHandler::TErrorState   ErrorState;
+    TRegisterHandler::TErrorState   ErrorState = TRegisterHandler::UnknownErrorState;
 };
 
 
@@ -84,7 +86,8 @@ private:
 
     void SetValueToChannel(const PDeviceChannel & channel, const std::string & value);
     void OnValueRead(PRegister reg, bool changed);
-    TRegisterHandler::TErrorState RegErrorState(PRegister reg);
+    TDeviceChannelState* GetChannelState(const PRegister& reg);
+    TRegisterHandler::TErrorState RegErrorState(const PRegister& reg);
     void UpdateError(PRegister reg, TRegisterHandler::TErrorState errorState);
 
     WBMQTT::PDeviceDriver      MqttDriver;
@@ -94,7 +97,7 @@ private:
     std::string                Description;
     WBMQTT::TPublishParameters PublishPolicy;
 
-    std::unordered_map<PRegister, TDeviceChannelState> RegisterToChannelStateMap;
+    std::vector<TDeviceChannelState> ChannelStates; /* indexed by TRegister::GetClientIndex() */
 };
 
 typedef std::shared_ptr<TSerialPortDriver> PSerialPortDriver;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <sstream>
 
@@ -37,4 +38,19 @@ struct TSerialPortSettings: public TSerialPortByteFormat
 
     std::string Device;
     int         BaudRate;
+
+    //! Wait for actual transmit completion and adapt timeouts to measured tty latency
+    bool        PreciseTiming = false;
+
+    //! Enable kernel RS-485 mode, the driver switches transmitter direction with RTS
+    bool        Rs485 = false;
+
+    std::chrono::milliseconds Rs485DelayRtsBeforeSend = std::chrono::milliseconds::zero();
+    std::chrono::milliseconds Rs485DelayRtsAfterSend  = std::chrono::milliseconds::zero();
+
+    //! Set ASYNC_LOW_LATENCY flag, received data is pushed to tty layer immediately
+    bool        LowLatency = false;
+
+    //! UART receive FIFO trigger level in bytes, 0 - driver's default
+    int         RxTriggerBytes = 0;
 };
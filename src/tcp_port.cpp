@@ -9,6 +9,8 @@
 #include <iostream>
 
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <netdb.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -21,85 +23,225 @@
 using namespace std;
 
 namespace {
-    const int CONNECTION_TIMEOUT_S = 5;
+    const std::chrono::seconds      ConnectionTimeout(5);
+    const std::chrono::milliseconds ConnectionPollInterval(100);
 
-    // Additional timeout for reading from tcp port. It is caused by intermediate hardware and internal Linux processing
-    // Values are taken from old default timeouts
-    const std::chrono::microseconds ResponseTCPLag = std::chrono::microseconds(500000);
-    const std::chrono::microseconds FrameTCPLag    = std::chrono::microseconds(150000);
+    // Delay before next connection attempt is doubled after every failure
+    const std::chrono::milliseconds MinReconnectDelay(100);
+    const std::chrono::milliseconds MaxReconnectDelay(10000);
+
+    const std::chrono::minutes      ConnectionErrorNotificationInterval(5);
+
+    // TCP keepalive settings to detect broken connections to a silent gateway
+    const int KeepAliveIdleS     = 10;
+    const int KeepAliveIntervalS = 2;
+    const int KeepAliveCount     = 3;
+
+    // Measured round trip time is reported to log not more often than this
+    const std::chrono::minutes      RttNotificationInterval(5);
+
+    void SetSocketOption(int fd, int level, int name, int value)
+    {
+        if (setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+            LOG(Warn) << "setsockopt(" << level << ", " << name << ") failed: " << FormatErrno(errno);
+        }
+    }
 }
 
 TTcpPort::TTcpPort(const TTcpPortSettings& settings)
-    : Settings(settings)
+    : Settings(settings),
+      ConnectRequested(false),
+      Stopped(false),
+      ConnectedFd(-1),
+      ConnectLogger(ConnectionErrorNotificationInterval, "[tcp port] "),
+      WaitingForResponse(false),
+      SmoothedRtt(std::chrono::microseconds::zero()),
+      RttVariation(std::chrono::microseconds::zero()),
+      ResponseLag(Settings.MaxResponseLag),
+      FrameLag(Settings.MaxFrameLag),
+      RoundTripTimeUs(0)
 {}
 
+TTcpPort::~TTcpPort()
+{
+    {
+        std::unique_lock<std::mutex> lock(ConnectMutex);
+        Stopped = true;
+    }
+    ConnectCondition.notify_all();
+    if (ConnectThread.joinable()) {
+        ConnectThread.join();
+    }
+    if (ConnectedFd >= 0) {
+        close(ConnectedFd);
+    }
+}
+
 void TTcpPort::Open()
 {
     if (IsOpen()) {
         throw TSerialDeviceException("port is already open");
     }
 
-    struct hostent* server = gethostbyname(Settings.Address.c_str());
-    if (!server) {
-        throw TSerialDeviceException("no such host: " + Settings.Address);
+    {
+        std::unique_lock<std::mutex> lock(ConnectMutex);
+        if (ConnectedFd >= 0) {
+            Fd = ConnectedFd;
+            ConnectedFd = -1;
+        }
     }
 
-    Fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (Fd < 0) {
-        throw TSerialDeviceErrnoException("cannot open tcp port: ", errno);
+    if (IsOpen()) {
+        LastInteraction = std::chrono::steady_clock::now();
+        return;
     }
 
-    struct sockaddr_in serv_addr;
-    bzero((char *) &serv_addr, sizeof(serv_addr));
-    serv_addr.sin_family = AF_INET;
-    bcopy((char *)server->h_addr, (char *)&serv_addr.sin_addr.s_addr, server->h_length);
-    serv_addr.sin_port = htons(Settings.Port);
+    RequestConnection();
+}
 
-    // set socket to non-blocking state
-    auto arg = fcntl(Fd, F_GETFL, NULL);
-    arg |= O_NONBLOCK;
-    fcntl(Fd, F_SETFL, arg);
+void TTcpPort::Reopen()
+{
+    if (IsOpen()) {
+        // Don't wait for the new connection here, the port is picked up
+        // by Open() from the closed port cycle as soon as it is ready
+        Close();
+        Open();
+    }
+}
 
-    try {
-        if (connect(Fd, (struct sockaddr *) &serv_addr,sizeof(serv_addr)) < 0) {
+void TTcpPort::RequestConnection()
+{
+    std::unique_lock<std::mutex> lock(ConnectMutex);
+    ConnectRequested = true;
+    if (!ConnectThread.joinable()) {
+        ConnectThread = std::thread([this]() { ConnectLoop(); });
+    }
+    ConnectCondition.notify_all();
+}
+
+void TTcpPort::WaitForOpen(const std::chrono::milliseconds& timeout)
+{
+    std::unique_lock<std::mutex> lock(ConnectMutex);
+    ConnectCondition.wait_for(lock, timeout, [this]() { return ConnectedFd >= 0 || Stopped; });
+}
+
+void TTcpPort::ConnectLoop()
+{
+    auto reconnectDelay = MinReconnectDelay;
+    std::unique_lock<std::mutex> lock(ConnectMutex);
+    while (!Stopped) {
+        ConnectCondition.wait(lock, [this]() { return ConnectRequested || Stopped; });
+        if (Stopped) {
+            break;
+        }
+
+        lock.unlock();
+        int fd = -1;
+        try {
+            fd = Connect();
+            ConnectLogger.DropTimeout();
+        } catch (const std::runtime_error& e) {
+            ConnectLogger.Log(GetDescription() + " " + e.what(), Debug, Error);
+        }
+        lock.lock();
+
+        if (fd >= 0) {
+            if (ConnectedFd >= 0) {
+                close(ConnectedFd);
+            }
+            ConnectedFd = fd;
+            ConnectRequested = false;
+            reconnectDelay = MinReconnectDelay;
+            ConnectCondition.notify_all();
+        } else {
+            ConnectCondition.wait_for(lock, reconnectDelay, [this]() { return Stopped; });
+            reconnectDelay = std::min(reconnectDelay * 2, MaxReconnectDelay);
+        }
+    }
+}
+
+int TTcpPort::Connect()
+{
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    auto res = getaddrinfo(Settings.Address.c_str(), std::to_string(Settings.Port).c_str(), &hints, &addresses);
+    if (res != 0) {
+        throw std::runtime_error("no such host: " + Settings.Address + " (" + gai_strerror(res) + ")");
+    }
+    std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> addressesHolder(addresses, &freeaddrinfo);
+
+    std::string error("no address");
+    for (auto address = addresses; address; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            error = "cannot open tcp port: " + FormatErrno(errno);
+            continue;
+        }
+
+        if (connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
             if (errno != EINPROGRESS) {
-                throw std::runtime_error("connect error: " + FormatErrno(errno));
+                error = "connect error: " + FormatErrno(errno);
+                close(fd);
+                continue;
             }
-            timeval tv = {CONNECTION_TIMEOUT_S, 0};
-            fd_set myset;
-            FD_ZERO(&myset);
-            FD_SET(Fd, &myset);
-            auto res = select(Fd + 1, NULL, &myset, NULL, &tv);
-            if (res > 0) {
-                socklen_t lon = sizeof(int);
-                int valopt;
-                getsockopt(Fd, SOL_SOCKET, SO_ERROR, (void*)(&valopt), &lon);
-                if (valopt) {
-                    throw std::runtime_error("connect error: " + FormatErrno(valopt));
+
+            // Wait in short slices to stop quickly on port destruction
+            pollfd pfd = {fd, POLLOUT, 0};
+            auto deadline = std::chrono::steady_clock::now() + ConnectionTimeout;
+            int pollRes = 0;
+            while (pollRes == 0 && std::chrono::steady_clock::now() < deadline) {
+                {
+                    std::unique_lock<std::mutex> lock(ConnectMutex);
+                    if (Stopped) {
+                        close(fd);
+                        throw std::runtime_error("port is closed");
+                    }
                 }
-            } else if (res < 0 && errno != EINTR) {
-                throw std::runtime_error("connect error: " + FormatErrno(errno));
-            } else {
-                throw std::runtime_error("connect error: timeout");
+                pollRes = poll(&pfd, 1, ConnectionPollInterval.count());
+                if (pollRes < 0 && errno == EINTR) {
+                    pollRes = 0;
+                }
+            }
+            int valopt = 0;
+            if (pollRes > 0) {
+                socklen_t lon = sizeof(valopt);
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &valopt, &lon);
+            }
+            if (pollRes <= 0 || valopt) {
+                if (pollRes == 0) {
+                    error = "connect error: timeout";
+                } else {
+                    error = "connect error: " + FormatErrno(pollRes < 0 ? errno : valopt);
+                }
+                close(fd);
+                continue;
             }
         }
-    } catch (const std::runtime_error& e) {
-        close(Fd);
-        Fd = -1;
-        throw TSerialDeviceException(GetDescription() + " " + e.what());
-    }
 
-    // set socket back to blocking state
-    arg = fcntl(Fd, F_GETFL, NULL);
-    arg &= (~O_NONBLOCK);
-    fcntl(Fd, F_SETFL, arg);
+        SetSocketOption(fd, IPPROTO_TCP, TCP_NODELAY, 1);
+        SetSocketOption(fd, SOL_SOCKET, SO_KEEPALIVE, 1);
+        SetSocketOption(fd, IPPROTO_TCP, TCP_KEEPIDLE, KeepAliveIdleS);
+        SetSocketOption(fd, IPPROTO_TCP, TCP_KEEPINTVL, KeepAliveIntervalS);
+        SetSocketOption(fd, IPPROTO_TCP, TCP_KEEPCNT, KeepAliveCount);
+
+        // set socket back to blocking state
+        auto arg = fcntl(fd, F_GETFL, NULL);
+        arg &= (~O_NONBLOCK);
+        fcntl(fd, F_SETFL, arg);
 
-    LastInteraction = std::chrono::steady_clock::now();
+        return fd;
+    }
+    throw std::runtime_error(error);
 }
 
 void TTcpPort::OnReadyEmptyFd()
 {
     Close();
+    RequestConnection();
     throw TSerialDeviceTransientErrorException("socket closed");
 }
 
@@ -107,6 +249,8 @@ void TTcpPort::WriteBytes(const uint8_t * buf, int count)
 {
     if (IsOpen()) {
         Base::WriteBytes(buf, count);
+        LastWrite = LastInteraction;
+        WaitingForResponse = true;
     } else {
         LOG(Debug) << "Attempt to write to not open port";
     }
@@ -114,7 +258,15 @@ void TTcpPort::WriteBytes(const uint8_t * buf, int count)
 
 uint8_t TTcpPort::ReadByte(const std::chrono::microseconds& timeout)
 {
-    return Base::ReadByte(timeout + ResponseTCPLag);
+    try {
+        auto b = Base::ReadByte(timeout + ResponseLag);
+        AddRttSample(LastInteraction);
+        return b;
+    } catch (const TSerialDeviceTransientErrorException&) {
+        // Don't take into account responses to retransmitted or timed out requests (Karn's algorithm)
+        WaitingForResponse = false;
+        throw;
+    }
 }
 
 size_t TTcpPort::ReadFrame(uint8_t * buf, 
@@ -124,12 +276,65 @@ size_t TTcpPort::ReadFrame(uint8_t * buf,
                            TFrameCompletePred frame_complete)
 {
     if (IsOpen()) {
-        return Base::ReadFrame(buf, count, responseTimeout + ResponseTCPLag, frameTimeout + FrameTCPLag, frame_complete);
+        try {
+            auto res = Base::ReadFrame(buf, count, responseTimeout + ResponseLag, frameTimeout + FrameLag, frame_complete);
+            AddRttSample(LastFrameStart);
+            return res;
+        } catch (const TSerialDeviceTransientErrorException&) {
+            WaitingForResponse = false;
+            throw;
+        }
     }
     LOG(Debug) << "Attempt to read from not open port";
     return 0;
 }
 
+void TTcpPort::AddRttSample(const TTimePoint& responseTime)
+{
+    if (!WaitingForResponse) {
+        return;
+    }
+    WaitingForResponse = false;
+
+    // Jacobson/Karels estimation as in RFC 6298. Time between request and response includes device processing time,
+    // so the lag covers it too
+    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(responseTime - LastWrite);
+    if (rtt.count() < 0) {
+        return;
+    }
+    if (SmoothedRtt.count() == 0) {
+        SmoothedRtt = rtt;
+        RttVariation = rtt / 2;
+    } else {
+        auto delta = (SmoothedRtt > rtt) ? (SmoothedRtt - rtt) : (rtt - SmoothedRtt);
+        RttVariation = (3 * RttVariation + delta) / 4;
+        SmoothedRtt = (7 * SmoothedRtt + rtt) / 8;
+    }
+    RoundTripTimeUs = SmoothedRtt.count();
+
+    auto minResponseLag = std::chrono::duration_cast<std::chrono::microseconds>(Settings.MinResponseLag);
+    auto maxResponseLag = std::chrono::duration_cast<std::chrono::microseconds>(Settings.MaxResponseLag);
+    ResponseLag = std::min(std::max(SmoothedRtt + 4 * RttVariation, minResponseLag), maxResponseLag);
+
+    // Frames can be split into several TCP segments by intermediate hardware,
+    // delays between them are estimated from round trip time variation
+    auto minFrameLag = std::chrono::duration_cast<std::chrono::microseconds>(Settings.MinFrameLag);
+    auto maxFrameLag = std::chrono::duration_cast<std::chrono::microseconds>(Settings.MaxFrameLag);
+    FrameLag = std::min(std::max(4 * RttVariation, minFrameLag), maxFrameLag);
+
+    if (responseTime - LastRttNotification >= RttNotificationInterval) {
+        LastRttNotification = responseTime;
+        LOG(Info) << GetDescription() << " round trip time: " << SmoothedRtt.count() << " us, variation: "
+                  << RttVariation.count() << " us, response lag: " << ResponseLag.count() << " us, frame lag: "
+                  << FrameLag.count() << " us";
+    }
+}
+
+std::chrono::microseconds TTcpPort::GetRoundTripTime() const
+{
+    return std::chrono::microseconds(RoundTripTimeUs.load());
+}
+
 std::string TTcpPort::GetDescription(bool verbose) const
 {
     if (verbose) {
@@ -2,27 +2,73 @@
 
 #include "file_descriptor_port.h"
 #include "tcp_port_settings.h"
+#include "log.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
+/*!
+ * TCP port. Name resolution and connection are done in a background thread
+ * with exponential backoff between failed attempts. Open() doesn't block:
+ * it takes established connection if any and requests a new one otherwise,
+ * so the port may stay closed after Open(). Sockets use TCP_NODELAY and keepalive.
+ * Additional response and frame timeouts are adapted to measured round trip time,
+ * the time is reported to log every few minutes.
+ */
 class TTcpPort final: public TFileDescriptorPort
 {
     using Base = TFileDescriptorPort;
 public:
     TTcpPort(const TTcpPortSettings& settings);
-    ~TTcpPort() = default;
+    ~TTcpPort();
 
     void Open() override;
+    void Reopen() override;
     void WriteBytes(const uint8_t * buf, int count) override;
     uint8_t ReadByte(const std::chrono::microseconds& timeout) override;
     size_t ReadFrame(uint8_t * buf, size_t count,
                      const std::chrono::microseconds & responseTimeout,
                      const std::chrono::microseconds& frameTimeout,
                      TFrameCompletePred frame_complete = 0) override;
+    void WaitForOpen(const std::chrono::milliseconds& timeout) override;
 
     std::string GetDescription(bool verbose = true) const override;
 
+    //! Smoothed time between request and first byte of response, zero if it is not measured yet. Thread safe
+    std::chrono::microseconds GetRoundTripTime() const;
+
 private:
     void OnReadyEmptyFd() override;
 
+    void RequestConnection();
+    void ConnectLoop();
+
+    //! Returns connected socket, throws std::runtime_error on errors
+    int Connect();
+
+    //! Update round trip time estimation and timeout lags
+    void AddRttSample(const TTimePoint& responseTime);
+
     TTcpPortSettings                        Settings;
+
+    // Connection state shared with ConnectThread
+    std::mutex                              ConnectMutex;
+    std::condition_variable                 ConnectCondition;
+    std::thread                             ConnectThread;
+    bool                                    ConnectRequested;
+    bool                                    Stopped;
+    int                                     ConnectedFd;
+    TLoggerWithTimeout                      ConnectLogger;
+
+    // Round trip time estimation, used only by port thread
+    TTimePoint                              LastWrite;
+    bool                                    WaitingForResponse;
+    std::chrono::microseconds               SmoothedRtt;
+    std::chrono::microseconds               RttVariation;
+    std::chrono::microseconds               ResponseLag;
+    std::chrono::microseconds               FrameLag;
+    std::atomic<int64_t>                    RoundTripTimeUs;
+    TTimePoint                              LastRttNotification;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <sstream>
 
@@ -19,4 +20,12 @@ struct TTcpPortSettings
 
     std::string                 Address;
     uint16_t                    Port;
+
+    //! Bounds of additional response timeout calculated from measured round trip time
+    std::chrono::milliseconds   MinResponseLag = std::chrono::milliseconds(10);
+    std::chrono::milliseconds   MaxResponseLag = std::chrono::milliseconds(500);
+
+    //! Bounds of additional frame timeout calculated from round trip time variation
+    std::chrono::milliseconds   MinFrameLag = std::chrono::milliseconds(20);
+    std::chrono::milliseconds   MaxFrameLag = std::chrono::milliseconds(150);
 };
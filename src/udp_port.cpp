@@ -0,0 +1,92 @@
+#include "udp_port.h"
+#include "serial_exc.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "log.h"
+
+#define LOG(logger) ::logger.Log() << "[udp port] "
+
+using namespace std;
+
+namespace {
+    // Additional response timeout for network delays. Unlike TCP there is no acknowledgement
+    // to measure round trip time, so fixed value is used
+    const chrono::milliseconds ResponseLag(100);
+}
+
+TUdpPort::TUdpPort(const TUdpPortSettings& settings)
+    : Settings(settings)
+{}
+
+void TUdpPort::Open()
+{
+    if (IsOpen()) {
+        throw TSerialDeviceException("port is already open");
+    }
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* addresses = nullptr;
+    auto res = getaddrinfo(Settings.Address.c_str(), to_string(Settings.Port).c_str(), &hints, &addresses);
+    if (res != 0) {
+        throw TSerialDeviceException("no such host: " + Settings.Address + " (" + gai_strerror(res) + ")");
+    }
+    unique_ptr<addrinfo, decltype(&freeaddrinfo)> addressesHolder(addresses, &freeaddrinfo);
+
+    string error("no address");
+    for (auto address = addresses; address; address = address->ai_next) {
+        int fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            error = "cannot open udp port: " + FormatErrno(errno);
+            continue;
+        }
+        // Connected socket filters datagrams from other hosts and reports ICMP errors
+        if (connect(fd, address->ai_addr, address->ai_addrlen) < 0) {
+            error = "connect error: " + FormatErrno(errno);
+            close(fd);
+            continue;
+        }
+        Fd = fd;
+        LastInteraction = chrono::steady_clock::now();
+        return;
+    }
+    throw TSerialDeviceException(GetDescription() + " " + error);
+}
+
+uint8_t TUdpPort::ReadByte(const chrono::microseconds& timeout)
+{
+    return Base::ReadByte(timeout + ResponseLag);
+}
+
+size_t TUdpPort::ReadFrame(uint8_t * buf,
+                           size_t count,
+                           const chrono::microseconds & responseTimeout,
+                           const chrono::microseconds& frameTimeout,
+                           TFrameCompletePred frame_complete)
+{
+    // One read() takes exactly one datagram, so the frame ends when the buffer is empty
+    auto datagramComplete = [&](uint8_t* buf, int size) {
+        if (size == 0 || HasBufferedData()) {
+            return false;
+        }
+        return !frame_complete || frame_complete(buf, size);
+    };
+    return Base::ReadFrame(buf, count, responseTimeout + ResponseLag, frameTimeout, datagramComplete);
+}
+
+string TUdpPort::GetDescription(bool verbose) const
+{
+    if (verbose) {
+        return Settings.ToString();
+    }
+    return Settings.Address;
+}
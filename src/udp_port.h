@@ -0,0 +1,29 @@
+#pragma once
+
+#include "file_descriptor_port.h"
+#include "udp_port_settings.h"
+
+/*!
+ * UDP port. Uses connected socket, so only datagrams from the remote address are received.
+ * Gateways send every frame in a datagram, so ReadFrame returns as soon as a datagram is received
+ * and doesn't wait for frame timeout. Next datagram is waited only if frame_complete predicate
+ * reports that the frame is split between several datagrams.
+ */
+class TUdpPort final: public TFileDescriptorPort
+{
+    using Base = TFileDescriptorPort;
+public:
+    TUdpPort(const TUdpPortSettings& settings);
+
+    void Open() override;
+    uint8_t ReadByte(const std::chrono::microseconds& timeout) override;
+    size_t ReadFrame(uint8_t * buf, size_t count,
+                     const std::chrono::microseconds & responseTimeout,
+                     const std::chrono::microseconds& frameTimeout,
+                     TFrameCompletePred frame_complete = 0) override;
+
+    std::string GetDescription(bool verbose = true) const override;
+
+private:
+    TUdpPortSettings Settings;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+
+struct TUdpPortSettings
+{
+    TUdpPortSettings(const std::string& address = "localhost", uint16_t port = 0)
+        : Address(address)
+        , Port(port)
+    {}
+
+    std::string ToString() const
+    {
+        std::ostringstream ss;
+        ss << "<udp " << Address << ":" << Port << ">";
+        return ss.str();
+    }
+
+    std::string Address;
+    uint16_t    Port;
+};
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "devices/dlms_cache.h"
+
+class TDlmsCacheTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        FileName = "/tmp/dlms-cache-test-" + std::to_string(getpid()) + ".json";
+        remove(FileName.c_str());
+    }
+
+    void TearDown() override
+    {
+        remove(FileName.c_str());
+    }
+
+    std::string FileName;
+};
+
+TEST_F(TDlmsCacheTest, Persistence)
+{
+    TDlmsScalerUnit value;
+    {
+        TDlmsCache cache(FileName);
+        EXPECT_FALSE(cache.GetScalerUnit("1:123", "1.0.1.8.0.255", value));
+        cache.SetScalerUnit("1:123", "1.0.1.8.0.255", {-3, 30});
+        cache.SetScalerUnit("1:123", "1.0.32.7.0.255", {0, 35});
+        cache.SetScalerUnit("1:456", "1.0.1.8.0.255", {2, 30});
+        ASSERT_TRUE(cache.GetScalerUnit("1:123", "1.0.1.8.0.255", value));
+        EXPECT_EQ(-3, value.Scaler);
+        cache.Save();
+    }
+
+    TDlmsCache cache(FileName);
+    ASSERT_TRUE(cache.GetScalerUnit("1:123", "1.0.1.8.0.255", value));
+    EXPECT_EQ(-3, value.Scaler);
+    EXPECT_EQ(30, value.Unit);
+    ASSERT_TRUE(cache.GetScalerUnit("1:123", "1.0.32.7.0.255", value));
+    EXPECT_EQ(0, value.Scaler);
+    EXPECT_EQ(35, value.Unit);
+    ASSERT_TRUE(cache.GetScalerUnit("1:456", "1.0.1.8.0.255", value));
+    EXPECT_EQ(2, value.Scaler);
+    EXPECT_FALSE(cache.GetScalerUnit("1:456", "1.0.32.7.0.255", value));
+    EXPECT_FALSE(cache.GetScalerUnit("2:123", "1.0.1.8.0.255", value));
+}
+
+TEST_F(TDlmsCacheTest, BrokenFile)
+{
+    {
+        std::ofstream f(FileName);
+        f << "{ broken";
+    }
+    TDlmsCache cache(FileName);
+    TDlmsScalerUnit value;
+    EXPECT_FALSE(cache.GetScalerUnit("1:123", "1.0.1.8.0.255", value));
+    cache.SetScalerUnit("1:123", "1.0.1.8.0.255", {-1, 33});
+    cache.Save();
+
+    TDlmsCache cache2(FileName);
+    ASSERT_TRUE(cache2.GetScalerUnit("1:123", "1.0.1.8.0.255", value));
+    EXPECT_EQ(-1, value.Scaler);
+    EXPECT_EQ(33, value.Unit);
+}
+
+TEST_F(TDlmsCacheTest, ProfileTime)
+{
+    time_t value = 0;
+    {
+        TDlmsCache cache(FileName);
+        EXPECT_FALSE(cache.GetProfileTime("meter1:1.0.99.1.0.255:2", value));
+        cache.SetProfileTime("meter1:1.0.99.1.0.255:2", 1600000000);
+        cache.SetScalerUnit("1:123", "1.0.1.8.0.255", {-3, 30});
+        cache.Save();
+    }
+
+    TDlmsCache cache(FileName);
+    ASSERT_TRUE(cache.GetProfileTime("meter1:1.0.99.1.0.255:2", value));
+    EXPECT_EQ(1600000000, value);
+    TDlmsScalerUnit scalerUnit;
+    ASSERT_TRUE(cache.GetScalerUnit("1:123", "1.0.1.8.0.255", scalerUnit));
+    EXPECT_EQ(-3, scalerUnit.Scaler);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include "devices/dlms_address.h"
+#include "devices/dlms_profile.h"
+#include "serial_config.h"
+
+namespace
+{
+    const time_t PERIOD = 1800;
+    const size_t MAX_ENTRIES = 8;
+    const time_t NOW = 1600000000;
+}
+
+TEST(TDlmsAddressTest, Parse)
+{
+    TObisRegisterAddress addr("1.0.1.8.0.255");
+    EXPECT_EQ("1.0.1.8.0.255", addr.GetLogicalName());
+    EXPECT_EQ(0, addr.GetColumn());
+    EXPECT_EQ("1.0.1.8.0.255", addr.ToString());
+
+    TObisRegisterAddress profileAddr("1.0.99.1.0.255:3");
+    EXPECT_EQ("1.0.99.1.0.255", profileAddr.GetLogicalName());
+    EXPECT_EQ(3, profileAddr.GetColumn());
+    EXPECT_EQ("1.0.99.1.0.255:3", profileAddr.ToString());
+
+    EXPECT_TRUE(addr < profileAddr);
+    EXPECT_FALSE(profileAddr < addr);
+}
+
+TEST(TDlmsAddressTest, BadAddress)
+{
+    EXPECT_THROW(TObisRegisterAddress("1.0.99.1.0.255:0"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0.99.1.0.255:"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0.99.1.0.255:a"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0.99.1.0.255:1:2"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0.99.1.0"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0..1.0.255"), TConfigParserException);
+    EXPECT_THROW(TObisRegisterAddress("1.0.x.1.0.255"), TConfigParserException);
+}
+
+TEST(TDlmsProfileTest, FirstRead)
+{
+    TDlmsProfileColumn column;
+    TDlmsProfileColumn::TRange range;
+    double value;
+    EXPECT_FALSE(column.Publish(value));
+
+    // Without mark the last entry is requested
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(NOW - 2 * PERIOD + 1, range.Start);
+    EXPECT_EQ(NOW, range.End);
+
+    column.AddEntry(NOW - PERIOD, 10);
+    column.EndRange(NOW);
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(10, value);
+    time_t mark;
+    ASSERT_TRUE(column.GetMark(mark));
+    EXPECT_EQ(NOW - PERIOD, mark);
+}
+
+TEST(TDlmsProfileTest, SkipBeforeNextCapture)
+{
+    TDlmsProfileColumn column;
+    TDlmsProfileColumn::TRange range;
+    double value;
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    column.AddEntry(NOW - PERIOD, 10);
+    column.EndRange(NOW);
+    ASSERT_TRUE(column.Publish(value));
+
+    // The next entry is captured at NOW, the meter must not be asked before
+    EXPECT_FALSE(column.GetRange(NOW - 1, PERIOD, MAX_ENTRIES, range));
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(10, value);
+
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(NOW - PERIOD + 1, range.Start);
+    EXPECT_EQ(NOW, range.End);
+}
+
+TEST(TDlmsProfileTest, ReadAfterRestart)
+{
+    TDlmsProfileColumn column;
+    TDlmsProfileColumn::TRange range;
+    double value;
+    column.SetMark(NOW - PERIOD);
+
+    // The last published entry is read again to have a value
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(NOW - 2 * PERIOD + 1, range.Start);
+    EXPECT_EQ(NOW, range.End);
+
+    // The entry at start of range is ignored
+    column.AddEntry(NOW - 2 * PERIOD, 5);
+    column.AddEntry(NOW - PERIOD, 10);
+    column.AddEntry(NOW, 15);
+    column.EndRange(NOW);
+
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(10, value);
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(15, value);
+    EXPECT_FALSE(column.HasEntries());
+    time_t mark;
+    ASSERT_TRUE(column.GetMark(mark));
+    EXPECT_EQ(NOW, mark);
+}
+
+TEST(TDlmsProfileTest, FillGap)
+{
+    TDlmsProfileColumn column;
+    TDlmsProfileColumn::TRange range;
+    double value;
+    const time_t start = NOW - 100 * PERIOD;
+    column.SetMark(start);
+
+    // Range is limited by maximum number of entries
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(start - PERIOD + 1, range.Start);
+    EXPECT_EQ(start + (MAX_ENTRIES - 1) * PERIOD, range.End);
+
+    // The meter was off, nothing is captured. High-water mark is moved to the end of range
+    column.EndRange(NOW);
+    EXPECT_FALSE(column.Publish(value));
+    time_t mark;
+    ASSERT_TRUE(column.GetMark(mark));
+    EXPECT_EQ(range.End, mark);
+
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(mark - PERIOD + 1, range.Start);
+
+    // Entries are published one by one, the mark follows them
+    column.AddEntry(mark + PERIOD, 1);
+    column.AddEntry(mark + 2 * PERIOD, 2);
+    column.EndRange(NOW);
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(1, value);
+    time_t newMark;
+    ASSERT_TRUE(column.GetMark(newMark));
+    EXPECT_EQ(mark + PERIOD, newMark);
+    EXPECT_TRUE(column.HasEntries());
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(2, value);
+    ASSERT_TRUE(column.GetMark(newMark));
+    EXPECT_EQ(mark + 2 * PERIOD, newMark);
+
+    // No new entries, the last value is kept
+    ASSERT_TRUE(column.Publish(value));
+    EXPECT_EQ(2, value);
+}
+
+TEST(TDlmsProfileTest, EmptyRangeAtEnd)
+{
+    TDlmsProfileColumn column;
+    TDlmsProfileColumn::TRange range;
+    column.SetMark(NOW - 3 * PERIOD);
+    ASSERT_TRUE(column.GetRange(NOW, PERIOD, MAX_ENTRIES, range));
+    EXPECT_EQ(NOW, range.End);
+
+    // The range reaches current time, the entries may be captured later. The mark is kept
+    column.EndRange(NOW);
+    time_t mark;
+    ASSERT_TRUE(column.GetMark(mark));
+    EXPECT_EQ(NOW - 3 * PERIOD, mark);
+}
@@ -3,6 +3,7 @@
 #include "fake_serial_port.h"
 #include "devices/uniel_device.h"
 #include "uniel_expectations.h"
+#include "serial_config.h"
 
 class TDlmsDeviceExpectations: public virtual TExpectorProvider
 {
@@ -36,6 +37,80 @@ protected:
             { 0x7e, 0xa0, 0x14, 0x41, 0x02, 0x29, 0x74, 0x21, 0x90, 0xe6, 0xe7, 0x00, 0xc4, 0x01, 0x81, 0x00, 0x10, 0x00, 0x1e, 0x66, 0x3c, 0x7e },
             __func__);
     }
+
+    //! The meter supports multiple references (GET-Request-With-List) in negotiated conformance
+    void EnqueueConnectionWithListRequests()
+    {
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x08, 0x02, 0x29, 0x41, 0x53, 0x9e, 0xb4, 0x7e },
+            { 0x7e, 0xa0, 0x21, 0x41, 0x02, 0x29, 0x73, 0x1b, 0x16, 0x81, 0x80, 0x14, 0x05, 0x02, 0x00, 0x80, 0x06, 0x02, 0x00, 0x80, 0x07, 0x04, 0x00, 0x00, 0x00, 0x01, 0x08, 0x04, 0x00, 0x00, 0x00, 0x01, 0xce, 0x6a, 0x7e },
+            __func__);
+
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x08, 0x02, 0x29, 0x41, 0x93, 0x92, 0x72, 0x7e },
+            { 0x7e, 0xa0, 0x21, 0x41, 0x02, 0x29, 0x73, 0x1b, 0x16, 0x81, 0x80, 0x14, 0x05, 0x02, 0x00, 0x80, 0x06, 0x02, 0x00, 0x80, 0x07, 0x04, 0x00, 0x00, 0x00, 0x01, 0x08, 0x04, 0x00, 0x00, 0x00, 0x01, 0xce, 0x6a, 0x7e },
+            __func__);
+
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x43, 0x02, 0x29, 0x41, 0x10, 0xcf, 0x42, 0xe6, 0xe6, 0x00, 0x60, 0x34, 0xa1, 0x09, 0x06, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01, 0x8a, 0x02, 0x07, 0x80, 0x8b, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x02, 0x01, 0xac, 0x08, 0x80, 0x06, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31, 0xbe, 0x10, 0x04, 0x0e, 0x01, 0x00, 0x00, 0x00, 0x06, 0x5f, 0x1f, 0x04, 0x00, 0x00, 0x1e, 0x5d, 0xff, 0xff, 0xa0, 0xfd, 0x7e },
+            { 0x7e, 0xa0, 0x38, 0x41, 0x02, 0x29, 0x30, 0xa0, 0x83, 0xe6, 0xe7, 0x00, 0x61, 0x29, 0xa1, 0x09, 0x06, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01, 0xa2, 0x03, 0x02, 0x01, 0x00, 0xa3, 0x05, 0xa1, 0x03, 0x02, 0x01, 0x00, 0xbe, 0x10, 0x04, 0x0e, 0x08, 0x00, 0x06, 0x5f, 0x1f, 0x04, 0x00, 0x00, 0x12, 0x1d, 0x00, 0x64, 0x00, 0x07, 0xd4, 0x83, 0x7e },
+            __func__);
+    }
+
+    //! The meter accepts HDLC window size 2
+    void EnqueueConnectionWithWindowRequests()
+    {
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x08, 0x02, 0x29, 0x41, 0x53, 0x9e, 0xb4, 0x7e },
+            { 0x7e, 0xa0, 0x21, 0x41, 0x02, 0x29, 0x73, 0x1b, 0x16, 0x81, 0x80, 0x14, 0x05, 0x02, 0x00, 0x80, 0x06, 0x02, 0x00, 0x80, 0x07, 0x04, 0x00, 0x00, 0x00, 0x02, 0x08, 0x04, 0x00, 0x00, 0x00, 0x02, 0x3b, 0xf0, 0x7e },
+            __func__);
+
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x08, 0x02, 0x29, 0x41, 0x93, 0x92, 0x72, 0x7e },
+            { 0x7e, 0xa0, 0x21, 0x41, 0x02, 0x29, 0x73, 0x1b, 0x16, 0x81, 0x80, 0x14, 0x05, 0x02, 0x00, 0x80, 0x06, 0x02, 0x00, 0x80, 0x07, 0x04, 0x00, 0x00, 0x00, 0x02, 0x08, 0x04, 0x00, 0x00, 0x00, 0x02, 0x3b, 0xf0, 0x7e },
+            __func__);
+
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x43, 0x02, 0x29, 0x41, 0x10, 0xcf, 0x42, 0xe6, 0xe6, 0x00, 0x60, 0x34, 0xa1, 0x09, 0x06, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01, 0x8a, 0x02, 0x07, 0x80, 0x8b, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x02, 0x01, 0xac, 0x08, 0x80, 0x06, 0x31, 0x31, 0x31, 0x31, 0x31, 0x31, 0xbe, 0x10, 0x04, 0x0e, 0x01, 0x00, 0x00, 0x00, 0x06, 0x5f, 0x1f, 0x04, 0x00, 0x00, 0x1e, 0x5d, 0xff, 0xff, 0xa0, 0xfd, 0x7e },
+            { 0x7e, 0xa0, 0x38, 0x41, 0x02, 0x29, 0x30, 0xa0, 0x83, 0xe6, 0xe7, 0x00, 0x61, 0x29, 0xa1, 0x09, 0x06, 0x07, 0x60, 0x85, 0x74, 0x05, 0x08, 0x01, 0x01, 0xa2, 0x03, 0x02, 0x01, 0x00, 0xa3, 0x05, 0xa1, 0x03, 0x02, 0x01, 0x00, 0xbe, 0x10, 0x04, 0x0e, 0x08, 0x00, 0x06, 0x5f, 0x1f, 0x04, 0x00, 0x00, 0x10, 0x1d, 0x00, 0x64, 0x00, 0x07, 0x82, 0x8b, 0x7e },
+            __func__);
+    }
+
+    //! Value of 0.0.96.9.0.255 comes in two segments sent back to back and received by one read
+    void EnqueueSegmentedValueRequests()
+    {
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x1a, 0x02, 0x29, 0x41, 0x32, 0xd9, 0x64, 0xe6, 0xe6, 0x00, 0xc0, 0x01, 0x81, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x03, 0x00, 0x8e, 0xb5, 0x7e },
+            { 0x7e, 0xa0, 0x17, 0x41, 0x02, 0x29, 0x52, 0xd9, 0xc9, 0xe6, 0xe7, 0x00, 0xc4, 0x01, 0x81, 0x00, 0x02, 0x02, 0x0f, 0x00, 0x16, 0x09, 0xae, 0xd5, 0x7e },
+            __func__);
+
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x1a, 0x02, 0x29, 0x41, 0x54, 0xe9, 0x62, 0xe6, 0xe6, 0x00, 0xc0, 0x01, 0x81, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x02, 0x00, 0x56, 0xac, 0x7e },
+            { 0x7e, 0xa8, 0x0f, 0x41, 0x02, 0x29, 0x64, 0x54, 0x52, 0xe6, 0xe7, 0x00, 0xc4, 0x01, 0xe6, 0xc3, 0x7e,
+              0x7e, 0xa0, 0x0f, 0x41, 0x02, 0x29, 0x76, 0x9f, 0x40, 0x81, 0x00, 0x10, 0x00, 0x1e, 0x0b, 0x71, 0x7e },
+            __func__);
+    }
+
+    // GET-Request-With-List frames below are composed by hand by IEC 62056-5-3 encoding, HCS and FCS are checked.
+    // They are not yet compared with frames of a Gurux client or a meter capture, as well as expected logs of the tests using them
+
+    //! Scaler, unit and value of 0.0.96.9.0.255 and 1.0.1.8.0.255 by one request
+    void EnqueueReadWithListRequest()
+    {
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x39, 0x02, 0x29, 0x41, 0x32, 0x84, 0x19, 0xe6, 0xe6, 0x00, 0xc0, 0x03, 0x81, 0x04, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x03, 0x00, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x02, 0x00, 0x00, 0x03, 0x01, 0x00, 0x01, 0x08, 0x00, 0xff, 0x03, 0x00, 0x00, 0x03, 0x01, 0x00, 0x01, 0x08, 0x00, 0xff, 0x02, 0x00, 0x14, 0x08, 0x7e },
+            { 0x7e, 0xa0, 0x29, 0x41, 0x02, 0x29, 0x52, 0xb0, 0x7c, 0xe6, 0xe7, 0x00, 0xc4, 0x03, 0x81, 0x04, 0x00, 0x02, 0x02, 0x0f, 0x00, 0x16, 0x09, 0x00, 0x10, 0x00, 0x1e, 0x00, 0x02, 0x02, 0x0f, 0x00, 0x16, 0x1e, 0x00, 0x06, 0x00, 0x00, 0x04, 0xd2, 0x53, 0xe9, 0x7e },
+            __func__);
+    }
+
+    //! The same request, but FCS of the response is broken
+    void EnqueueReadWithListBadFcsRequest()
+    {
+        Expector()->Expect(
+            { 0x7e, 0xa0, 0x39, 0x02, 0x29, 0x41, 0x32, 0x84, 0x19, 0xe6, 0xe6, 0x00, 0xc0, 0x03, 0x81, 0x04, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x03, 0x00, 0x00, 0x03, 0x00, 0x00, 0x60, 0x09, 0x00, 0xff, 0x02, 0x00, 0x00, 0x03, 0x01, 0x00, 0x01, 0x08, 0x00, 0xff, 0x03, 0x00, 0x00, 0x03, 0x01, 0x00, 0x01, 0x08, 0x00, 0xff, 0x02, 0x00, 0x14, 0x08, 0x7e },
+            { 0x7e, 0xa0, 0x29, 0x41, 0x02, 0x29, 0x52, 0xb0, 0x7c, 0xe6, 0xe7, 0x00, 0xc4, 0x03, 0x81, 0x04, 0x00, 0x02, 0x02, 0x0f, 0x00, 0x16, 0x09, 0x00, 0x10, 0x00, 0x1e, 0x00, 0x02, 0x02, 0x0f, 0x00, 0x16, 0x1e, 0x00, 0x06, 0x00, 0x00, 0x04, 0xd2, 0x53, 0x16, 0x7e },
+            __func__);
+    }
 };
 
 class TDlmsIntegrationTest: public TSerialDeviceIntegrationTest, public TDlmsDeviceExpectations
@@ -60,3 +135,89 @@ TEST_F(TDlmsIntegrationTest, Poll)
     Note() << "LoopOnce()";
     SerialDriver->LoopOnce();
 }
+
+class TDlmsTest: public TSerialDeviceTest, public TDlmsDeviceExpectations
+{
+protected:
+    void SetUp() override
+    {
+        TSerialDeviceTest::SetUp();
+        SerialPort->Open();
+    }
+
+    //! Creates the same device as in configs/config-dlms-test.json with a register per address
+    PSerialDevice CreateDevice(const std::vector<std::string>& addresses)
+    {
+        Json::Value config;
+        config["name"] = "DLMS";
+        config["id"] = "dlms";
+        config["slave_id"] = 20;
+        config["dlms_auth"] = 1;
+        config["dlms_client_address"] = 32;
+        for (int i = 0; i < 6; ++i) {
+            config["password"].append(0x31);
+        }
+        config["response_timeout_ms"] = 1000;
+        config["frame_timeout_ms"] = 20;
+        config["protocol"] = "dlms";
+        for (const auto& address: addresses) {
+            Json::Value channel;
+            channel["name"] = address;
+            channel["reg_type"] = "default";
+            channel["address"] = address;
+            channel["type"] = "value";
+            config["channels"].append(channel);
+        }
+
+        auto portConfig = std::make_shared<TPortConfig>();
+        portConfig->Port = SerialPort;
+        TTemplateMap templates;
+        auto device = DeviceFactory.CreateDevice(config, "dlms", portConfig, templates);
+        for (const auto& channel: device->DeviceConfig()->DeviceChannelConfigs) {
+            Registers.push_back(TRegister::Intern(device, channel->RegisterConfigs.front()));
+        }
+        return device;
+    }
+
+    std::vector<PRegister> Registers;
+};
+
+TEST_F(TDlmsTest, ReadWithList)
+{
+    auto device = CreateDevice({"0.0.96.9.0.255", "1.0.1.8.0.255"});
+    EnqueueConnectionWithListRequests();
+    device->Prepare();
+
+    EnqueueReadWithListRequest();
+    device->ReadRegisterRange(std::make_shared<TSimpleRegisterRange>(Registers));
+    EXPECT_EQ(ST_OK, Registers[0]->GetError());
+    EXPECT_EQ(CopyDoubleToUint64(30), Registers[0]->GetValue());
+    EXPECT_EQ(ST_OK, Registers[1]->GetError());
+    EXPECT_EQ(CopyDoubleToUint64(1234), Registers[1]->GetValue());
+    SerialPort->Close();
+}
+
+TEST_F(TDlmsTest, ReadWithListBrokenFrame)
+{
+    auto device = CreateDevice({"0.0.96.9.0.255", "1.0.1.8.0.255"});
+    EnqueueConnectionWithListRequests();
+    device->Prepare();
+
+    // Broken frame is a transport error, registers are not read one by one
+    EnqueueReadWithListBadFcsRequest();
+    device->ReadRegisterRange(std::make_shared<TSimpleRegisterRange>(Registers));
+    EXPECT_EQ(ST_UNKNOWN_ERROR, Registers[0]->GetError());
+    EXPECT_EQ(ST_UNKNOWN_ERROR, Registers[1]->GetError());
+    SerialPort->Close();
+}
+
+TEST_F(TDlmsTest, TwoFramesInOneRead)
+{
+    auto device = CreateDevice({"0.0.96.9.0.255"});
+    EnqueueConnectionWithWindowRequests();
+    device->Prepare();
+
+    EnqueueSegmentedValueRequests();
+    EXPECT_EQ(CopyDoubleToUint64(30), device->ReadRegister(Registers[0]));
+    SerialPort->Close();
+}
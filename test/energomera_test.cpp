@@ -4,6 +4,26 @@
 
 namespace
 {
+    class TEnergomeraTest: public TSerialDeviceTest
+    {
+    protected:
+        std::shared_ptr<TEnergomeraIecWithFastReadDevice> Dev;
+
+        void SetUp()
+        {
+            TSerialDeviceTest::SetUp();
+            auto cfg = std::make_shared<TDeviceConfig>("energomera", "00000211", "energomera_iec");
+            cfg->FrameTimeout = std::chrono::milliseconds::zero();
+            Dev = std::make_shared<TEnergomeraIecWithFastReadDevice>(cfg, SerialPort, DeviceFactory.GetProtocol("energomera_iec"));
+            SerialPort->Open();
+        }
+
+        PRegister Reg(uint32_t address)
+        {
+            return TRegister::Intern(Dev, TRegisterConfig::Create(0, address, Double));
+        }
+    };
+
     class TEnergomeraIntegrationTest: public TSerialDeviceIntegrationTest, public virtual TExpectorProvider
     {
     protected:
@@ -28,3 +48,67 @@ TEST_F(TEnergomeraIntegrationTest, Poll)
     Note() << "LoopOnce()";
     SerialDriver->LoopOnce();
 }
+
+TEST_F(TEnergomeraTest, SplitByResponseSize)
+{
+    auto frequency = Reg(0x400D01);
+    auto angle1 = Reg(0x400B01);
+    auto angle2 = Reg(0x400B02);
+    auto angle3 = Reg(0x400B03);
+    auto serial = Reg(0x500301);
+
+    Dev->SetMaxResponseSize(64);
+    auto ranges = Dev->SplitRegisterList({ frequency, angle1, angle2, serial, angle3 });
+
+    // Values of a parameter are always read by one request
+    ASSERT_EQ(2u, ranges.size());
+    ASSERT_EQ(TRegisterSpan(std::vector<PRegister>{ angle1, angle2, angle3 }), ranges[0]->RegisterList());
+    ASSERT_EQ(TRegisterSpan(std::vector<PRegister>{ frequency, serial }), ranges[1]->RegisterList());
+}
+
+TEST_F(TEnergomeraTest, Bisection)
+{
+    auto p1001 = Reg(0x100101);
+    auto p1004 = Reg(0x100401);
+    auto p1008 = Reg(0x100801);
+    auto p4001 = Reg(0x400101);
+    auto ranges = Dev->SplitRegisterList({ p1001, p1004, p1008, p4001, Reg(0x400102), Reg(0x400103) });
+    ASSERT_EQ(1u, ranges.size());
+
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(1001(1)1004(1)1008(1)4001(7))\x03\x09"),
+        ExpectVectorFromString("\x02(E12)\x03\x7c"),
+        "Group");
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(1001(1)1004(1))\x03\x71"),
+        ExpectVectorFromString("\x02""1001(0.8797784)1004(1.63211)\x03\x68"),
+        "First half");
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(1008(1)4001(7))\x03\x7e"),
+        ExpectVectorFromString("\x02(E12)\x03\x7c"),
+        "Second half");
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(1008(1))\x03\x31"),
+        ExpectVectorFromString("\x02""1008(0.085901)\x03\x32"),
+        "Param 1008");
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(4001(7))\x03\x33"),
+        ExpectVectorFromString("\x02(E12)\x03\x7c"),
+        "Param 4001");
+    auto newRanges = Dev->ReadRegisterRange(ranges[0]);
+
+    ASSERT_EQ(1u, newRanges.size());
+    ASSERT_EQ(ranges[0]->RegisterList(), newRanges[0]->RegisterList());
+    ASSERT_EQ(ST_DEVICE_ERROR, p4001->GetError());
+    ASSERT_FALSE(p4001->IsAvailable());
+
+    // Unsupported parameter isn't requested anymore, other ones are read by single request
+    Expector()->Expect(
+        ExpectVectorFromString("/?00000211!\x01R1\x02GROUP(1001(1)1004(1)1008(1))\x03\x3c"),
+        ExpectVectorFromString("\x02""1001(0.8797784)1004(1.63211)1008(0.085901)\x03\x17"),
+        "Group without 4001");
+    for (const auto& range: newRanges) {
+        Dev->ReadRegisterRange(range);
+    }
+    SerialPort->Close();
+}
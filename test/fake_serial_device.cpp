@@ -55,7 +55,7 @@ uint64_t TFakeSerialDevice::ReadRegister(PRegister reg)
             throw TSerialDeviceTransientErrorException("device disconnected");
         }
 
-        auto addr = GetUint32RegisterAddress(reg->GetAddress());
+        auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
 
         if(Blockings[addr].first) {
             throw TSerialDeviceTransientErrorException("read blocked");
@@ -65,17 +65,17 @@ uint64_t TFakeSerialDevice::ReadRegister(PRegister reg)
             throw runtime_error("invalid register address");
         }
 
-        if (reg->Type != REG_FAKE) {
+        if (reg->GetConfig()->Type != REG_FAKE) {
             throw runtime_error("invalid register type");
         }
 
-        auto value = GetValue(&Registers[addr], reg->Get16BitWidth());
+        auto value = GetValue(&Registers[addr], reg->GetConfig()->Get16BitWidth());
 
-        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': read address '" << reg->GetAddress() << "' value '" << value << "'";
+        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': read address '" << reg->GetConfig()->GetAddress() << "' value '" << value << "'";
 
         return value;
     } catch (const exception & e) {
-        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': read address '" << reg->GetAddress() << "' failed: '" << e.what() << "'";
+        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': read address '" << reg->GetConfig()->GetAddress() << "' failed: '" << e.what() << "'";
 
         throw;
     }
@@ -92,7 +92,7 @@ void TFakeSerialDevice::WriteRegister(PRegister reg, uint64_t value)
             throw TSerialDeviceTransientErrorException("device disconnected");
         }
 
-        auto addr = GetUint32RegisterAddress(reg->GetAddress());
+        auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
 
         if(Blockings[addr].second) {
             throw TSerialDeviceTransientErrorException("write blocked");
@@ -102,15 +102,15 @@ void TFakeSerialDevice::WriteRegister(PRegister reg, uint64_t value)
             throw runtime_error("invalid register address");
         }
 
-        if (reg->Type != REG_FAKE) {
+        if (reg->GetConfig()->Type != REG_FAKE) {
             throw runtime_error("invalid register type");
         }
 
-        SetValue(&Registers[addr], reg->Get16BitWidth(), value);
+        SetValue(&Registers[addr], reg->GetConfig()->Get16BitWidth(), value);
 
-        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': write to address '" << reg->GetAddress() << "' value '" << value << "'";
+        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': write to address '" << reg->GetConfig()->GetAddress() << "' value '" << value << "'";
     } catch (const exception & e) {
-        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': write address '" << reg->GetAddress() << "' failed: '" << e.what() << "'";
+        FakePort->GetFixture().Emit() << "fake_serial_device '" << SlaveId << "': write address '" << reg->GetConfig()->GetAddress() << "' failed: '" << e.what() << "'";
 
         throw;
     }
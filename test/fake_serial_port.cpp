@@ -219,6 +219,12 @@ void TFakeSerialPort::DumpWhatWasRead()
     DumpPos = RespPos;
 }
 
+bool TFakeSerialPort::SetBaudRate(int baudRate)
+{
+    Fixture.Emit() << "SetBaudRate(" << baudRate << ")";
+    return true;
+}
+
 void TFakeSerialPort::Elapse(const std::chrono::milliseconds& ms)
 {
     Time += ms;
@@ -326,7 +332,7 @@ void TSerialDeviceIntegrationTest::SetUp()
                         DeviceFactory,
                         CommonConfigSchema,
                         it->second,
-                        [=](const Json::Value&) {return std::make_pair(SerialPort, false);});
+                        [=](const Json::Value&, size_t) {return std::make_pair(SerialPort, false);});
 
     MqttBroker = NewFakeMqttBroker(*this);
     MqttClient = MqttBroker->MakeClient("em-test");
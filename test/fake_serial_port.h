@@ -37,6 +37,8 @@ public:
 
     std::chrono::milliseconds GetSendTime(double bytesNumber) override;
 
+    bool SetBaudRate(int baudRate) override;
+
     void Expect(const std::vector<int>& request, const std::vector<int>& response, const char* func = 0);
     void DumpWhatWasRead();
     void Elapse(const std::chrono::milliseconds& ms);
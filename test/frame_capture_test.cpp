@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "replay_port.h"
+#include "serial_port.h"
+#include "serial_exc.h"
+
+namespace
+{
+    TFrameTraceRecord MakeTraceRecord(TFrameDirection direction, const std::vector<uint8_t>& data)
+    {
+        TFrameTraceRecord record;
+        record.Time = std::chrono::steady_clock::now();
+        record.Direction = direction;
+        record.Data = data;
+        return record;
+    }
+}
+
+class TFrameCaptureTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        FileName = "/tmp/wb-mqtt-serial-capture-test-" + std::to_string(getpid());
+    }
+
+    void TearDown() override
+    {
+        unlink(FileName.c_str());
+        unlink((FileName + ".1").c_str());
+    }
+
+    std::string FileName;
+};
+
+TEST_F(TFrameCaptureTest, WriteRead)
+{
+    {
+        TFrameCaptureWriter writer(FileName);
+        EXPECT_EQ(0, writer.AddPort("/dev/ttyRS485-1"));
+        EXPECT_EQ(1, writer.AddPort("192.168.1.1:502"));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Write, {0x01, 0x03, 0x00, 0x00}));
+        writer.Write(1, MakeTraceRecord(TFrameDirection::Noise, {0xFF}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, {0x01, 0x03, 0x02}));
+    }
+
+    auto records = ReadFrameCapture(FileName);
+    ASSERT_EQ(5u, records.size());
+    EXPECT_EQ(TFrameCaptureRecordType::Port, records[0].Type);
+    EXPECT_EQ("/dev/ttyRS485-1", std::string(records[0].Data.begin(), records[0].Data.end()));
+    EXPECT_EQ(TFrameCaptureRecordType::Port, records[1].Type);
+    EXPECT_EQ(1, records[1].Port);
+    EXPECT_EQ(TFrameCaptureRecordType::Write, records[2].Type);
+    EXPECT_EQ((std::vector<uint8_t>{0x01, 0x03, 0x00, 0x00}), records[2].Data);
+    EXPECT_EQ(TFrameCaptureRecordType::Noise, records[3].Type);
+    EXPECT_EQ(1, records[3].Port);
+    EXPECT_EQ(TFrameCaptureRecordType::Read, records[4].Type);
+    EXPECT_EQ(0, records[4].Port);
+    EXPECT_LE(records[2].Time, records[4].Time);
+}
+
+TEST_F(TFrameCaptureTest, Rotate)
+{
+    const size_t maxFileSize = 128 * 1024;
+    const size_t FRAME_SIZE = 256;
+    {
+        TFrameCaptureWriter writer(FileName, maxFileSize);
+        writer.AddPort("/dev/ttyRS485-1");
+        std::vector<uint8_t> frame(FRAME_SIZE, 0x55);
+        for (size_t i = 0; i < maxFileSize / frame.size() + 1; ++i) {
+            writer.Write(0, MakeTraceRecord(TFrameDirection::Read, frame));
+        }
+    }
+
+    auto oldRecords = ReadFrameCapture(FileName + ".1");
+    auto records = ReadFrameCapture(FileName);
+    ASSERT_FALSE(records.empty());
+    EXPECT_EQ(TFrameCaptureRecordType::Port, oldRecords[0].Type);
+    // Every file starts with port descriptions
+    EXPECT_EQ(TFrameCaptureRecordType::Port, records[0].Type);
+    EXPECT_EQ("/dev/ttyRS485-1", std::string(records[0].Data.begin(), records[0].Data.end()));
+    EXPECT_EQ(maxFileSize / FRAME_SIZE + 3, oldRecords.size() + records.size());
+}
+
+TEST_F(TFrameCaptureTest, RotationError)
+{
+    // Rename fails if the old file name is taken by a non-empty directory
+    auto oldFileName = FileName + ".1";
+    auto blockerFileName = oldFileName + "/blocker";
+    ASSERT_EQ(0, mkdir(oldFileName.c_str(), 0755));
+    fclose(fopen(blockerFileName.c_str(), "w"));
+    {
+        TFrameCaptureWriter writer(FileName, 128 * 1024);
+        writer.AddPort("/dev/ttyRS485-1");
+        std::vector<uint8_t> frame(UINT16_MAX, 0x55);
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, frame));
+        EXPECT_THROW(writer.Write(0, MakeTraceRecord(TFrameDirection::Read, frame)), std::runtime_error);
+        EXPECT_NO_THROW(writer.Write(0, MakeTraceRecord(TFrameDirection::Read, frame)));
+    }
+    unlink(blockerFileName.c_str());
+    rmdir(oldFileName.c_str());
+
+    auto records = ReadFrameCapture(FileName);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(TFrameCaptureRecordType::Read, records[1].Type);
+}
+
+TEST_F(TFrameCaptureTest, LongFrame)
+{
+    std::vector<uint8_t> frame(3000);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = i;
+    }
+    {
+        TFrameCaptureWriter writer(FileName);
+        writer.AddPort("/dev/ttyRS485-1");
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, frame));
+        auto truncated = MakeTraceRecord(TFrameDirection::Read, {0x01});
+        truncated.Truncated = true;
+        writer.Write(0, truncated);
+    }
+
+    auto records = ReadFrameCapture(FileName);
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ(frame, records[1].Data);
+    EXPECT_FALSE(records[1].Truncated);
+    EXPECT_EQ(TFrameCaptureRecordType::Read, records[2].Type);
+    EXPECT_TRUE(records[2].Truncated);
+
+    // Replay of corrupted data is pointless
+    EXPECT_THROW(TReplayPort(records, "/dev/ttyRS485-1"), std::runtime_error);
+}
+
+TEST_F(TFrameCaptureTest, Replay)
+{
+    {
+        TFrameCaptureWriter writer(FileName);
+        writer.AddPort("/dev/ttyRS485-1");
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Noise, {0xFF}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Write, {0x01, 0x03}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, {0x01, 0x03, 0x02}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Write, {0x02, 0x03}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Write, {0x03, 0x03}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, {0x03}));
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Read, {0x04}));
+    }
+
+    TReplayPort replayPort(ReadFrameCapture(FileName), "/dev/ttyRS485-1", 10);
+    TPort& port = replayPort;
+    EXPECT_EQ("replay of /dev/ttyRS485-1", port.GetDescription());
+    port.Open();
+    port.SkipNoise();
+
+    uint8_t buf[10];
+    port.WriteBytes(std::vector<uint8_t>{0x01, 0x03});
+    ASSERT_EQ(3u, port.ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)));
+    EXPECT_EQ(0x02, buf[2]);
+
+    // No response is recorded
+    port.WriteBytes(std::vector<uint8_t>{0x02, 0x03});
+    EXPECT_THROW(port.ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)),
+                 TSerialDeviceTransientErrorException);
+
+    port.WriteBytes(std::vector<uint8_t>{0x03, 0x03});
+    EXPECT_EQ(0x03, port.ReadByte(std::chrono::milliseconds(100)));
+    EXPECT_EQ(0x04, port.ReadByte(std::chrono::milliseconds(100)));
+    EXPECT_THROW(port.ReadByte(std::chrono::milliseconds(100)), TSerialDeviceTransientErrorException);
+    EXPECT_TRUE(replayPort.IsFinished());
+
+    // Virtual time runs faster than real one
+    auto start = port.CurrentTime();
+    auto realStart = std::chrono::steady_clock::now();
+    port.SleepSinceLastInteraction(std::chrono::milliseconds(200));
+    EXPECT_GE(port.CurrentTime() - start, std::chrono::milliseconds(100));
+    EXPECT_LT(std::chrono::steady_clock::now() - realStart, std::chrono::milliseconds(100));
+    port.Close();
+}
+
+TEST_F(TFrameCaptureTest, ReplayPortFactory)
+{
+    {
+        TFrameCaptureWriter writer(FileName);
+        writer.AddPort("/dev/ttyRS485-1");
+        writer.AddPort("<192.168.1.1:502>");
+        writer.AddPort("<192.168.1.1:502>#1");
+        writer.Write(0, MakeTraceRecord(TFrameDirection::Write, {0x01}));
+        writer.Write(1, MakeTraceRecord(TFrameDirection::Write, {0x02}));
+        writer.Write(2, MakeTraceRecord(TFrameDirection::Write, {0x03}));
+        writer.Write(2, MakeTraceRecord(TFrameDirection::Read, {0x04}));
+    }
+    auto factory = MakeReplayPortFactory(FileName, 10);
+
+    // Connections to the same endpoint have the same description, traffic is matched by port id
+    Json::Value tcpConfig;
+    tcpConfig["port_type"] = "tcp";
+    tcpConfig["address"] = "192.168.1.1";
+    tcpConfig["port"] = 502;
+    auto port = factory(tcpConfig, 1).first;
+    EXPECT_EQ("replay of <192.168.1.1:502>#1", port->GetDescription());
+    EXPECT_FALSE(port->SetBaudRate(9600));
+    port->Open();
+    port->WriteBytes(std::vector<uint8_t>{0x03});
+    EXPECT_EQ(0x04, port->ReadByte(std::chrono::milliseconds(100)));
+    port->Close();
+
+    // Serial ports are wrapped like live ones
+    Json::Value serialConfig;
+    serialConfig["path"] = "/dev/ttyRS485-1";
+    serialConfig["baud_rate"] = 9600;
+    auto serialPort = factory(serialConfig, 0).first;
+    EXPECT_TRUE(std::dynamic_pointer_cast<TSerialPortWithIECHack>(serialPort) != nullptr);
+    serialPort->Open();
+    EXPECT_TRUE(serialPort->SetBaudRate(19200));
+    serialPort->Close();
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <thread>
+#include <vector>
+
+#include "frame_trace.h"
+
+TEST(TFrameTraceTest, Disabled)
+{
+    TFrameTrace trace(4);
+    uint8_t buf[] = {0x01, 0x02};
+    trace.Push(TFrameDirection::Write, buf, sizeof(buf));
+
+    TFrameTraceRecord record;
+    EXPECT_FALSE(trace.Pop(record));
+}
+
+TEST(TFrameTraceTest, RingIsAllocatedOnEnabling)
+{
+    // Ring is large enough to be allocated by mmap
+#if __GLIBC_PREREQ(2, 33)
+    auto heapInUse = []() { auto info = mallinfo2(); return info.uordblks + info.hblkhd; };
+#else
+    auto heapInUse = []() { auto info = mallinfo(); return size_t(info.uordblks + info.hblkhd); };
+#endif
+    auto heap = heapInUse();
+    auto trace = std::make_unique<TFrameTrace>(1024);
+    EXPECT_LT(heapInUse() - heap, TFrameTrace::CHUNK_SIZE);
+
+    trace->SetEnabled(true);
+    EXPECT_GT(heapInUse() - heap, 1024 * TFrameTrace::CHUNK_SIZE);
+
+    uint8_t buf[] = {0x01, 0x02};
+    trace->Push(TFrameDirection::Write, buf, sizeof(buf));
+    trace->SetEnabled(false);
+    trace->SetEnabled(true);
+    TFrameTraceRecord record;
+    EXPECT_TRUE(trace->Pop(record));
+}
+
+TEST(TFrameTraceTest, PushPop)
+{
+    TFrameTrace trace(2);
+    trace.SetEnabled(true);
+
+    uint8_t req[] = {0x01, 0x03, 0xab};
+    uint8_t resp[] = {0x01};
+    trace.Push(TFrameDirection::Write, req, sizeof(req));
+    trace.Push(TFrameDirection::Read, resp, sizeof(resp));
+    trace.Push(TFrameDirection::Noise, resp, sizeof(resp));
+    EXPECT_EQ(1u, trace.TakeDropped());
+    EXPECT_EQ(0u, trace.TakeDropped());
+
+    TFrameTraceRecord record;
+    ASSERT_TRUE(trace.Pop(record));
+    EXPECT_EQ(TFrameDirection::Write, record.Direction);
+    EXPECT_EQ((std::vector<uint8_t>{0x01, 0x03, 0xab}), record.Data);
+    auto formatted = FormatFrameTraceRecord(record);
+    EXPECT_EQ(": Write: 01 03 ab", formatted.substr(formatted.find(':')));
+
+    ASSERT_TRUE(trace.Pop(record));
+    EXPECT_EQ(TFrameDirection::Read, record.Direction);
+    EXPECT_EQ(0x01, record.Data[0]);
+    EXPECT_FALSE(trace.Pop(record));
+}
+
+TEST(TFrameTraceTest, LongFrame)
+{
+    TFrameTrace trace(4);
+    trace.SetEnabled(true);
+
+    std::vector<uint8_t> frame(TFrameTrace::CHUNK_SIZE * 2 + 10);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = i;
+    }
+    trace.Push(TFrameDirection::Read, frame.data(), frame.size());
+
+    // Only one free slot is left
+    uint8_t req[] = {0x01, 0x03};
+    trace.Push(TFrameDirection::Write, frame.data(), TFrameTrace::CHUNK_SIZE + 1);
+    trace.Push(TFrameDirection::Write, req, sizeof(req));
+    EXPECT_EQ(1u, trace.TakeDropped());
+
+    TFrameTraceRecord record;
+    ASSERT_TRUE(trace.Pop(record));
+    EXPECT_EQ(TFrameDirection::Read, record.Direction);
+    EXPECT_FALSE(record.Truncated);
+    EXPECT_EQ(frame, record.Data);
+    auto formatted = FormatFrameTraceRecord(record);
+    EXPECT_EQ(" ... (522 bytes)", formatted.substr(formatted.rfind(" ...")));
+
+    ASSERT_TRUE(trace.Pop(record));
+    EXPECT_EQ(TFrameDirection::Write, record.Direction);
+    EXPECT_EQ(2u, record.Data.size());
+    EXPECT_FALSE(trace.Pop(record));
+}
+
+TEST(TFrameTraceTest, Truncate)
+{
+    TFrameTrace trace(300);
+    trace.SetEnabled(true);
+
+    std::vector<uint8_t> frame(TFrameTraceRecord::MAX_SIZE + 10, 0x55);
+    trace.Push(TFrameDirection::Read, frame.data(), frame.size());
+
+    TFrameTraceRecord record;
+    ASSERT_TRUE(trace.Pop(record));
+    EXPECT_TRUE(record.Truncated);
+    EXPECT_EQ(TFrameTraceRecord::MAX_SIZE, record.Data.size());
+    auto formatted = FormatFrameTraceRecord(record);
+    EXPECT_EQ(" ... (65535+ bytes)", formatted.substr(formatted.rfind(" ...")));
+}
+
+TEST(TFrameTraceTest, ConcurrentProducerAndConsumer)
+{
+    const int FRAME_COUNT = 10000;
+    TFrameTrace trace(16);
+    trace.SetEnabled(true);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < FRAME_COUNT; ++i) {
+            uint8_t buf[] = {uint8_t(i), uint8_t(i >> 8)};
+            trace.Push(TFrameDirection::Write, buf, sizeof(buf));
+        }
+    });
+
+    int received = 0;
+    int dropped = 0;
+    int last = -1;
+    TFrameTraceRecord record;
+    while (received + dropped < FRAME_COUNT) {
+        while (trace.Pop(record)) {
+            int value = record.Data[0] | (record.Data[1] << 8);
+            EXPECT_LT(last, value);
+            last = value;
+            ++received;
+        }
+        dropped += trace.TakeDropped();
+        std::this_thread::yield();
+    }
+    producer.join();
+    EXPECT_EQ(FRAME_COUNT, received + dropped);
+    EXPECT_GT(received, 0);
+}
@@ -669,3 +669,79 @@ void TMercury230Expectations::EnqueueMercury230InternalMeterErrorResponse()
             0x71  // crc
         }, __func__);
 }
+
+void TMercury230Expectations::EnqueueMercury230UGroupResponse()
+{
+    Expector()->Expect(
+        {
+            0x00, // unit id
+            0x08, // op
+            0x16, // addr
+            0x11, // addr
+            0x4f, // crc
+            0x8a  // crc
+        },
+        {
+            0x00, // unit id (group)
+            0x00, // U1
+            0x40, // U1
+            0x5e, // U1
+            0x00, // U2
+            0xeb, // U2
+            0x5d, // U2
+            0x00, // U3
+            0xe5, // U3
+            0xc4, // U3
+            0xb7, // crc
+            0x4a  // crc
+        }, __func__);
+}
+
+void TMercury230Expectations::EnqueueMercury230PGroupResponse()
+{
+    Expector()->Expect(
+        {
+            0x00, // unit id
+            0x08, // op
+            0x16, // addr
+            0x00, // addr
+            0x8f, // crc
+            0x86  // crc
+        },
+        {
+            0x00, // unit id (group)
+            0x48, // P
+            0x87, // P
+            0x70, // P
+            0xc8, // P1
+            0x87, // P1
+            0x70, // P1
+            0xc8, // P2
+            0x87, // P2
+            0x76, // P2
+            0xc8, // P3
+            0x87, // P3
+            0xbb, // P3
+            0x41, // crc
+            0x71  // crc
+        }, __func__);
+}
+
+void TMercury230Expectations::EnqueueMercury230IGroupUnsupportedResponse()
+{
+    Expector()->Expect(
+        {
+            0x00, // unit id
+            0x08, // op
+            0x16, // addr
+            0x21, // addr
+            0x4f, // crc
+            0x9e  // crc
+        },
+        {
+            0x00, // unit id (group)
+            0x01, // error 1 = invalid command or parameter
+            0xc0, // crc
+            0x70  // crc
+        }, __func__);
+}
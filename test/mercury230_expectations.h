@@ -42,4 +42,8 @@ public:
 	void EnqueueMercury230PerPhaseEnergyResponse();
 	void EnqueueMercury230NoSessionResponse();
 	void EnqueueMercury230InternalMeterErrorResponse();
+
+	void EnqueueMercury230UGroupResponse();
+	void EnqueueMercury230PGroupResponse();
+	void EnqueueMercury230IGroupUnsupportedResponse();
 };
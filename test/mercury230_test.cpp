@@ -194,6 +194,115 @@ TEST_F(TMercury230Test, Exception)
     }
 }
 
+TEST_F(TMercury230Test, SharedSession)
+{
+    // Another device with the same slave id on the port uses already opened channel
+    auto dev2 = std::make_shared<TMercury230Device>(GetDeviceConfig(), SerialPort, DeviceFactory.GetProtocol("mercury230"));
+    auto u2Reg = TRegister::Intern(dev2, TRegisterConfig::Create(TMercury230Device::REG_PARAM, 0x1112, U24));
+
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230U1Response();
+    ASSERT_EQ(24128, Mercury230Dev->ReadRegister(Mercury230U1Reg));
+
+    EnqueueMercury230U2Response();
+    ASSERT_EQ(24043, dev2->ReadRegister(u2Reg));
+    SerialPort->Close();
+}
+
+TEST_F(TMercury230Test, SessionPerAccessLevel)
+{
+    // A device with other access level and password opens its own channel
+    auto config = GetDeviceConfig();
+    config->Password = {0x12, 0x13, 0x14, 0x15, 0x16, 0x17};
+    config->AccessLevel = 2;
+    auto dev2 = std::make_shared<TMercury230Device>(config, SerialPort, DeviceFactory.GetProtocol("mercury230"));
+    auto u2Reg = TRegister::Intern(dev2, TRegisterConfig::Create(TMercury230Device::REG_PARAM, 0x1112, U24));
+
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230U1Response();
+    ASSERT_EQ(24128, Mercury230Dev->ReadRegister(Mercury230U1Reg));
+
+    EnqueueMercury230AccessLevel2SessionSetupResponse();
+    EnqueueMercury230U2Response();
+    ASSERT_EQ(24043, dev2->ReadRegister(u2Reg));
+
+    // The meter has only one channel, so it is reopened for the first device
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230U3Response();
+    ASSERT_EQ(50405, Mercury230Dev->ReadRegister(Mercury230U3Reg));
+    SerialPort->Close();
+}
+
+TEST_F(TMercury230Test, SessionTimeout)
+{
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230U1Response();
+    ASSERT_EQ(24128, Mercury230Dev->ReadRegister(Mercury230U1Reg));
+    Mercury230Dev->EndPollCycle();
+
+    SerialPort->Elapse(std::chrono::seconds(60));
+    EnqueueMercury230U2Response();
+    ASSERT_EQ(24043, Mercury230Dev->ReadRegister(Mercury230U2Reg));
+    Mercury230Dev->EndPollCycle();
+
+    // Meter has closed the channel, it is reopened before the request
+    SerialPort->Elapse(std::chrono::seconds(240));
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230U3Response();
+    ASSERT_EQ(50405, Mercury230Dev->ReadRegister(Mercury230U3Reg));
+    Mercury230Dev->EndPollCycle();
+    SerialPort->Close();
+}
+
+TEST_F(TMercury230Test, GroupReads)
+{
+    Mercury230Dev->SetGroupParamReads(true);
+    auto ranges = Mercury230Dev->SplitRegisterList({ Mercury230U1Reg, Mercury230TempReg, Mercury230U2Reg, Mercury230U3Reg,
+                                                     Mercury230PReg, Mercury230P1Reg, Mercury230P2Reg, Mercury230P3Reg,
+                                                     Mercury230I1Reg, Mercury230I2Reg });
+
+    // Temperature is not a per phase parameter and is read by a separate request,
+    // groups are ordered by BWRI: P, U, I
+    ASSERT_EQ(4u, ranges.size());
+    ASSERT_EQ(TRegisterSpan(std::vector<PRegister>{ Mercury230TempReg }), ranges[0]->RegisterList());
+    ASSERT_EQ(4u, ranges[1]->RegisterList().size());
+    ASSERT_EQ(3u, ranges[2]->RegisterList().size());
+    ASSERT_EQ(2u, ranges[3]->RegisterList().size());
+
+    EnqueueMercury230SessionSetupResponse();
+    EnqueueMercury230TempResponse();
+    Mercury230Dev->ReadRegisterRange(ranges[0]);
+    ASSERT_EQ(24, Mercury230TempReg->GetValue());
+
+    EnqueueMercury230PGroupResponse();
+    Mercury230Dev->ReadRegisterRange(ranges[1]);
+    ASSERT_EQ(553095, Mercury230PReg->GetValue());
+    ASSERT_EQ(uint32_t(-553095), Mercury230P1Reg->GetValue());
+    ASSERT_EQ(uint32_t(-554631), Mercury230P2Reg->GetValue());
+    ASSERT_EQ(uint32_t(-572295), Mercury230P3Reg->GetValue());
+
+    EnqueueMercury230UGroupResponse();
+    Mercury230Dev->ReadRegisterRange(ranges[2]);
+    ASSERT_EQ(24128, Mercury230U1Reg->GetValue());
+    ASSERT_EQ(24043, Mercury230U2Reg->GetValue());
+    ASSERT_EQ(50405, Mercury230U3Reg->GetValue());
+
+    // Meter doesn't support group reads, registers are read one by one from now on
+    EnqueueMercury230IGroupUnsupportedResponse();
+    EnqueueMercury230I1Response();
+    EnqueueMercury230I2Response();
+    Mercury230Dev->ReadRegisterRange(ranges[3]);
+    ASSERT_EQ(69, Mercury230I1Reg->GetValue());
+    ASSERT_EQ(96, Mercury230I2Reg->GetValue());
+
+    EnqueueMercury230U1Response();
+    EnqueueMercury230U2Response();
+    EnqueueMercury230U3Response();
+    Mercury230Dev->ReadRegisterRange(ranges[2]);
+    Mercury230Dev->EndPollCycle();
+    SerialPort->Close();
+}
+
 
 class TMercury230CustomPasswordTest : public TMercury230Test {
 public:
@@ -13,7 +13,7 @@ class TModbusTest: public TSerialDeviceTest, public TModbusExpectations
     typedef shared_ptr<TModbusDevice> PModbusDevice;
 protected:
     void SetUp();
-    set<int> VerifyQuery(list<PRegister> registerList = list<PRegister>());
+    set<int> VerifyQuery(vector<PRegister> registerList = vector<PRegister>());
 
     virtual PDeviceConfig GetDeviceConfig();
 
@@ -62,9 +62,9 @@ void TModbusTest::SetUp()
     SerialPort->Open();
 }
 
-set<int> TModbusTest::VerifyQuery(list<PRegister> registerList)
+set<int> TModbusTest::VerifyQuery(vector<PRegister> registerList)
 {
-    std::list<PRegisterRange> ranges;
+    std::vector<PRegisterRange> ranges;
 
     if (registerList.empty()) {
         registerList = {
@@ -86,7 +86,7 @@ set<int> TModbusTest::VerifyQuery(list<PRegister> registerList)
     for (auto range: ranges) {
         ModbusDev->ReadRegisterRange(range);
         for (auto& reg: range->RegisterList()) {
-            auto addr = GetUint32RegisterAddress(reg->GetAddress());
+            auto addr = GetUint32RegisterAddress(reg->GetConfig()->GetAddress());
             readAddresses.insert(addr);
             if (reg->GetError()) {
                 errorRegisters.insert(addr);
@@ -22,6 +22,22 @@ namespace
             }
         }
 
+        void EnqueueStartSession19200()
+        {
+            Expector()->Expect(
+                ExpectVectorFromString("/?00000201!\r\n"),
+                ExpectVectorFromString("/TPC6NEVAMT324.2307\r\n"),
+                __func__);
+        }
+
+        void EnqueueGoToProgMode19200()
+        {
+            Expector()->Expect(
+                ExpectVectorFromString("\x06""061\r\n"),
+                ExpectVectorFromString("\x01P0\x02(00000000)\x03\x60"),
+                __func__);
+        }
+
         void EnqueueGoToProgMode(bool error = false)
         {
             Expector()->Expect(
@@ -49,6 +65,33 @@ namespace
                 __func__);
         }
 
+        void EnqueueDataReadout()
+        {
+            Expector()->Expect(
+                ExpectVectorFromString("\x06""050\r\n"),
+                ExpectVectorFromString("\x02""16.7.0(00005.3*kW)\r\n"
+                                       "15.8.128(000046.24,000031.14,000015.10,000000.00,000000.00)\r\n"
+                                       "!\r\n\x03\x34"),
+                __func__);
+        }
+
+        void EnqueueMalformedDataReadout()
+        {
+            Expector()->Expect(
+                ExpectVectorFromString("\x06""050\r\n"),
+                ExpectVectorFromString("\x02""16.7.0(00005.3*kW)\r\n"
+                                       "!\r\n\x03\x35"),
+                __func__);
+        }
+
+        void EnqueueTemperatureRequest()
+        {
+            Expector()->Expect(
+                    ExpectVectorFromString("\x01R1\x02""600900FF()\x03\x6c"),
+                    ExpectVectorFromString("\x02""600900FF(029)\x03\x36"),
+                    __func__);
+        }
+
         void EnqueuePollRequests()
         {
             // Total P
@@ -154,6 +197,134 @@ TEST_F(TNevaTest, SendPasswordError)
     SerialPort->Close();
 }
 
+TEST_F(TNevaTest, DataReadout)
+{
+    Dev->SetDataReadout(true);
+    auto totalP = TRegister::Intern(Dev, TRegisterConfig::Create(8, 0x100700FF, Double));
+    auto totalA = TRegister::Intern(Dev, TRegisterConfig::Create(8, 0x0F0880FF, Double));
+    auto temperature = TRegister::Intern(Dev, TRegisterConfig::Create(10, 0x600900FF, Double));
+
+    // Data readout opens its own session
+    Dev->Prepare();
+
+    EnqueueStartSession();
+    EnqueueDataReadout();
+    ASSERT_EQ(CopyDoubleToUint64(5.3), Dev->ReadRegister(totalP));
+    ASSERT_EQ(CopyDoubleToUint64(46.24), Dev->ReadRegister(totalA));
+
+    // Missing in data readout, read by R1 request
+    EnqueueStartSession();
+    EnqueueGoToProgMode();
+    EnqueueSendPassword();
+    EnqueueTemperatureRequest();
+    ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+
+    Dev->EndPollCycle();
+
+    // Programming mode session must be closed before next data readout
+    EnqueueEndSession();
+    EnqueueStartSession();
+    EnqueueDataReadout();
+    ASSERT_EQ(CopyDoubleToUint64(5.3), Dev->ReadRegister(totalP));
+
+    SerialPort->Close();
+}
+
+TEST_F(TNevaTest, DataReadoutErrors)
+{
+    auto cfg = GetDeviceConfig();
+    cfg->DeviceTimeout = std::chrono::milliseconds::zero();
+    cfg->DeviceMaxFailCycles = 1;
+    Dev = std::make_shared<TNevaDevice>(cfg, SerialPort, DeviceFactory.GetProtocol("neva"));
+    Dev->SetDataReadout(true);
+    auto totalP = TRegister::Intern(Dev, TRegisterConfig::Create(8, 0x100700FF, Double));
+    auto temperature = TRegister::Intern(Dev, TRegisterConfig::Create(10, 0x600900FF, Double));
+    Dev->OnCycleEnd(true);
+
+    // Parameters are read one by one after three malformed data readouts
+    for (size_t i = 0; i < 3; ++i) {
+        Dev->Prepare();
+        if (i != 0) {
+            EnqueueEndSession();
+        }
+        EnqueueStartSession();
+        EnqueueMalformedDataReadout();
+        EnqueueEndSession();
+        EnqueueStartSession();
+        EnqueueGoToProgMode();
+        EnqueueSendPassword();
+        EnqueueTemperatureRequest();
+        ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+        Dev->EndPollCycle();
+        Dev->OnCycleEnd(true);
+    }
+
+    EnqueueStartSession();
+    EnqueueGoToProgMode();
+    EnqueueSendPassword();
+    Dev->Prepare();
+    EnqueueTemperatureRequest();
+    ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+    Dev->EndPollCycle();
+
+    // Data readout is tried again after reconnection
+    Dev->OnCycleEnd(false);
+    ASSERT_TRUE(Dev->GetIsDisconnected());
+    Dev->Prepare();
+    EnqueueEndSession();
+    EnqueueStartSession();
+    EnqueueDataReadout();
+    ASSERT_EQ(CopyDoubleToUint64(5.3), Dev->ReadRegister(totalP));
+
+    SerialPort->Close();
+}
+
+TEST_F(TNevaTest, SessionTimeout)
+{
+    auto temperature = TRegister::Intern(Dev, TRegisterConfig::Create(10, 0x600900FF, Double));
+
+    EnqueueStartSession();
+    EnqueueGoToProgMode();
+    EnqueueSendPassword();
+    Dev->Prepare();
+
+    EnqueueTemperatureRequest();
+    ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+    Dev->EndPollCycle();
+
+    // The session is still open
+    SerialPort->Elapse(std::chrono::seconds(30));
+    EnqueueTemperatureRequest();
+    ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+    Dev->EndPollCycle();
+
+    // The session is expired
+    SerialPort->Elapse(std::chrono::seconds(60));
+    EnqueueEndSession();
+    EnqueueStartSession();
+    EnqueueGoToProgMode();
+    EnqueueSendPassword();
+    EnqueueTemperatureRequest();
+    ASSERT_EQ(CopyDoubleToUint64(29), Dev->ReadRegister(temperature));
+
+    SerialPort->Close();
+}
+
+TEST_F(TNevaTest, BaudRateSwitching)
+{
+    Dev->SetBaudRateSwitching(true);
+
+    EnqueueStartSession19200();
+    EnqueueGoToProgMode19200();
+    EnqueueSendPassword();
+    Dev->Prepare();
+
+    EnqueueEndSession();
+    Dev->EndSession();
+
+    SerialPort->Close();
+}
+
 TEST_F(TNevaIntegrationTest, Poll)
 {
     EnqueueStartSession();
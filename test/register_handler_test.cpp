@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "register_handler.h"
+
+namespace
+{
+    const int PRODUCER_COUNT = 4;
+    const int SETS_PER_PRODUCER = 2000;
+    const int SHARED_REGISTER_ADDRESS = PRODUCER_COUNT;
+
+    class TRecordingDevice: public TSerialDevice
+    {
+    public:
+        TRecordingDevice(PDeviceConfig config, PProtocol protocol)
+            : TSerialDevice(config, nullptr, protocol)
+        {}
+
+        uint64_t ReadRegister(PRegister reg) override
+        {
+            return 0;
+        }
+
+        void WriteRegister(PRegister reg, uint64_t value) override
+        {
+            Writes[GetUint32RegisterAddress(reg->GetConfig()->GetAddress())].push_back(value);
+        }
+
+        // Written only by the flushing thread
+        std::map<uint32_t, std::vector<uint64_t>> Writes;
+    };
+}
+
+class TRegisterHandlerTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Device = std::make_shared<TRecordingDevice>(std::make_shared<TDeviceConfig>("test", "1", "test"), &Protocol);
+        for (int i = 0; i <= SHARED_REGISTER_ADDRESS; ++i) {
+            auto reg = TRegister::Intern(Device, TRegisterConfig::Create(0, i, U16));
+            Handlers.push_back(std::make_shared<TRegisterHandler>(Device, reg, FlushNeeded, FlushQueue));
+        }
+    }
+
+    // Emulates TSerialClient::DoFlush and polling of the port thread
+    void FlushAndPoll()
+    {
+        FlushQueue->PopAll(PendingFlushes);
+        size_t stillPending = 0;
+        for (auto handler: PendingFlushes) {
+            if (handler->NeedToFlush()) {
+                handler->Flush();
+            }
+            if (handler->KeepInFlushQueue()) {
+                PendingFlushes[stillPending++] = handler;
+            }
+        }
+        PendingFlushes.resize(stillPending);
+
+        for (const auto& handler: Handlers) {
+            bool changed;
+            if (handler->NeedToPoll()) {
+                handler->AcceptDeviceValue(handler->Register()->GetValue(), true, &changed);
+            }
+        }
+    }
+
+    TUint32SlaveIdProtocol                Protocol{"test", TRegisterTypes({{0, "test", "value"}})};
+    std::shared_ptr<TRecordingDevice>     Device;
+    PBinarySemaphore                      FlushNeeded = std::make_shared<TBinarySemaphore>();
+    PFlushQueue                           FlushQueue = std::make_shared<TFlushQueue>();
+    std::vector<PRegisterHandler>         Handlers;
+    std::vector<TRegisterHandler*>        PendingFlushes;
+};
+
+TEST_F(TRegisterHandlerTest, CoalesceSets)
+{
+    Handlers[0]->SetTextValue("1");
+    Handlers[1]->SetTextValue("2");
+    Handlers[0]->SetTextValue("3");
+    EXPECT_TRUE(FlushNeeded->TryWait());
+
+    FlushAndPoll();
+    EXPECT_EQ(std::vector<uint64_t>{3}, Device->Writes[0]);
+    EXPECT_EQ(std::vector<uint64_t>{2}, Device->Writes[1]);
+    EXPECT_TRUE(PendingFlushes.empty());
+    EXPECT_FALSE(Handlers[0]->NeedToFlush());
+    EXPECT_EQ("3", Handlers[0]->TextValue());
+
+    FlushAndPoll();
+    EXPECT_EQ(1u, Device->Writes[0].size());
+
+    Handlers[0]->SetTextValue("4");
+    FlushAndPoll();
+    EXPECT_EQ((std::vector<uint64_t>{3, 4}), Device->Writes[0]);
+}
+
+TEST_F(TRegisterHandlerTest, ConcurrentSetTextValue)
+{
+    std::atomic<int> runningProducers(PRODUCER_COUNT);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCER_COUNT; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 1; i <= SETS_PER_PRODUCER; ++i) {
+                Handlers[p]->SetTextValue(std::to_string(i));
+                Handlers[SHARED_REGISTER_ADDRESS]->SetTextValue(std::to_string(p * SETS_PER_PRODUCER + i));
+            }
+            --runningProducers;
+        });
+    }
+
+    while (runningProducers) {
+        FlushAndPoll();
+    }
+    for (auto& producer: producers) {
+        producer.join();
+    }
+    FlushAndPoll();
+
+    EXPECT_TRUE(PendingFlushes.empty());
+    for (int p = 0; p < PRODUCER_COUNT; ++p) {
+        const auto& writes = Device->Writes[p];
+        ASSERT_FALSE(writes.empty());
+        EXPECT_EQ(static_cast<uint64_t>(SETS_PER_PRODUCER), writes.back());
+        EXPECT_TRUE(std::is_sorted(writes.begin(), writes.end())) << "register " << p;
+        EXPECT_FALSE(Handlers[p]->NeedToFlush());
+        EXPECT_EQ(std::to_string(SETS_PER_PRODUCER), Handlers[p]->TextValue());
+    }
+
+    // The last written value of the shared register is the last value of one of producers
+    const auto& sharedWrites = Device->Writes[SHARED_REGISTER_ADDRESS];
+    ASSERT_FALSE(sharedWrites.empty());
+    EXPECT_EQ(0u, sharedWrites.back() % SETS_PER_PRODUCER);
+    EXPECT_FALSE(Handlers[SHARED_REGISTER_ADDRESS]->NeedToFlush());
+}
@@ -0,0 +1,141 @@
+#include <malloc.h>
+#include <chrono>
+#include <gtest/gtest.h>
+
+#include "modbus_common.h"
+#include "serial_device.h"
+
+namespace
+{
+    const size_t REGISTER_COUNT = 10000;
+
+    class TTableTestDevice: public TSerialDevice, public TUInt32SlaveId
+    {
+    public:
+        TTableTestDevice(PDeviceConfig config, PProtocol protocol)
+            : TSerialDevice(config, nullptr, protocol), TUInt32SlaveId(config->SlaveId)
+        {}
+
+        uint64_t ReadRegister(PRegister) override
+        {
+            return 0;
+        }
+
+        void WriteRegister(PRegister, uint64_t) override
+        {}
+    };
+
+    size_t HeapInUse()
+    {
+#if __GLIBC_PREREQ(2, 33)
+        return mallinfo2().uordblks;
+#else
+        return mallinfo().uordblks;
+#endif
+    }
+}
+
+class TRegisterTableTest: public ::testing::Test
+{
+protected:
+    void SetUp()
+    {
+        Protocol = std::make_shared<TUint32SlaveIdProtocol>("fake", TRegisterTypes({{0, "holding", "value"}}));
+        Device = std::make_shared<TTableTestDevice>(std::make_shared<TDeviceConfig>("fake", "1", "fake"), Protocol.get());
+    }
+
+    std::shared_ptr<TUint32SlaveIdProtocol> Protocol;
+    std::shared_ptr<TTableTestDevice>       Device;
+};
+
+TEST_F(TRegisterTableTest, Intern)
+{
+    auto config = TRegisterConfig::Create(0, 10, U16);
+    auto reg = TRegister::Intern(Device, config);
+    EXPECT_EQ(reg, TRegister::Intern(Device, config));
+    EXPECT_EQ(reg, Device->GetRegisters()[reg->GetId()]);
+    EXPECT_EQ(config.get(), reg->GetConfig().get());
+
+    auto reg2 = TRegister::Intern(Device, TRegisterConfig::Create(0, 10, U16));
+    EXPECT_NE(reg, reg2);
+    EXPECT_EQ(reg->GetId() + 1, reg2->GetId());
+}
+
+// Registers share configs loaded from device description, a register itself must be much smaller than its config
+TEST_F(TRegisterTableTest, MemoryPerRegister)
+{
+    std::vector<PRegisterConfig> configs;
+    configs.reserve(REGISTER_COUNT);
+    auto heap = HeapInUse();
+    for (size_t i = 0; i < REGISTER_COUNT; ++i) {
+        configs.push_back(TRegisterConfig::Create(0, i, U16, 1, 0, 0, true, false, "holding"));
+    }
+    auto configSize = (HeapInUse() - heap) / REGISTER_COUNT;
+
+    heap = HeapInUse();
+    for (const auto& config: configs) {
+        TRegister::Intern(Device, config);
+    }
+    auto registerSize = (HeapInUse() - heap) / REGISTER_COUNT;
+
+    std::cout << "Heap per register config: " << configSize << " bytes, per register: " << registerSize << " bytes" << std::endl;
+    EXPECT_EQ(REGISTER_COUNT, Device->GetRegisters().size());
+    EXPECT_LT(registerSize, configSize);
+}
+
+TEST_F(TRegisterTableTest, SpanSubAndMerge)
+{
+    std::vector<PRegister> regs;
+    for (size_t i = 0; i < REGISTER_COUNT; ++i) {
+        regs.push_back(TRegister::Intern(Device, TRegisterConfig::Create(0, i, U16)));
+    }
+    TRegisterSpan span(regs);
+    ASSERT_EQ(REGISTER_COUNT, span.size());
+
+    std::vector<TRegisterSpan> subSpans;
+    subSpans.reserve(REGISTER_COUNT);
+    TRegisterSpan merged;
+    auto heap = HeapInUse();
+    for (size_t i = 0; i < REGISTER_COUNT; ++i) {
+        subSpans.push_back(span.Sub(i, 1));
+        merged = merged.Merge(subSpans.back());
+    }
+    EXPECT_EQ(heap, HeapInUse());
+    EXPECT_EQ(span, merged);
+    EXPECT_EQ(regs[10], subSpans[10].front());
+
+    // Not adjacent spans are copied
+    auto reordered = span.Sub(1, 1).Merge(span.Sub(0, 1));
+    EXPECT_EQ(TRegisterSpan(std::vector<PRegister>{regs[1], regs[0]}), reordered);
+
+    EXPECT_THROW(span.Sub(REGISTER_COUNT, 1), std::out_of_range);
+}
+
+// Splits a synthetic list of 10k modbus registers with holes, prints time and heap used per range
+TEST_F(TRegisterTableTest, SplitBenchmark)
+{
+    TDeviceConfig config("modbus", "1", "modbus");
+    config.MaxRegHole = 10;
+    config.MaxReadRegisters = 0;
+
+    std::vector<PRegister> regs;
+    for (size_t i = 0; i < REGISTER_COUNT; ++i) {
+        regs.push_back(TRegister::Intern(Device, TRegisterConfig::Create(Modbus::REG_HOLDING, i + i / 100, U16)));
+    }
+
+    auto heap = HeapInUse();
+    auto start = std::chrono::steady_clock::now();
+    auto ranges = Modbus::SplitRegisterList(regs, config, true);
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    auto heapPerRange = (HeapInUse() - heap) / ranges.size();
+
+    std::cout << REGISTER_COUNT << " registers are split into " << ranges.size() << " ranges in " << time.count()
+              << " us, heap per range: " << heapPerRange << " bytes" << std::endl;
+
+    size_t count = 0;
+    for (const auto& range: ranges) {
+        EXPECT_EQ(regs[count], range->RegisterList().front());
+        count += range->RegisterList().size();
+    }
+    EXPECT_EQ(REGISTER_COUNT, count);
+}
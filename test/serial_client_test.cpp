@@ -98,7 +98,7 @@ void TSerialClientTest::SetUp()
 #endif
     SerialClient->SetReadCallback([this](PRegister reg, bool changed) {
             Emit() << "Read Callback: <"
-                   << reg->Device()->ToString() << ":" << reg->TypeName << ": " << reg->GetAddress() << "> becomes "
+                   << reg->Device()->ToString() << ":" << reg->GetConfig()->TypeName << ": " << reg->GetConfig()->GetAddress() << "> becomes "
                    << SerialClient->GetTextValue(reg) << (changed ? "" : " [unchanged]");
         });
     SerialClient->SetErrorCallback(
@@ -117,14 +117,13 @@ void TSerialClientTest::SetUp()
             default:
                 what = "no error";
             }
-            Emit() << "Error Callback: <" << reg->Device()->ToString() << ":" << reg->TypeName << ": " << reg->GetAddress() << ">: " << what;
+            Emit() << "Error Callback: <" << reg->Device()->ToString() << ":" << reg->GetConfig()->TypeName << ": " << reg->GetConfig()->GetAddress() << ">: " << what;
         });
 }
 
 void TSerialClientTest::TearDown()
 {
     TLoggedFixture::TearDown();
-    TRegister::DeleteIntern();
     TFakeSerialDevice::ClearDevices();
 }
 
@@ -900,13 +899,27 @@ TEST_F(TSerialClientTest, Errors)
     SerialClient->SetTextValue(reg20, "42");
     Note() << "Cycle() [write, nothing blacklisted]";
     SerialClient->Cycle();
+}
 
+TEST_F(TSerialClientTest, ErrorValue)
+{
+    // Register config is shared and immutable, so the error value is set when the config is created
+    PRegister reg20 = TRegister::Intern(
+        Device, TRegisterConfig::Create(
+        TFakeSerialDevice::REG_FAKE, 20, U16, 1, 0, 0, true, false,
+        "fake", std::make_unique<uint64_t>(42)));
+    SerialClient->AddRegister(reg20);
+    Device->Registers[20] = 42;
+
+    Note() << "Cycle() [read, error value]";
+    SerialClient->Cycle();
 
-    reg20->ErrorValue = std::make_unique<uint64_t>(42);
-    Note() << "Cycle() [read, set error value for register]";
+    Device->Registers[20] = 43;
+    Note() << "Cycle() [read, normal value]";
     SerialClient->Cycle();
-    SerialClient->GetTextValue(reg20);
 
+    Device->Registers[20] = 42;
+    Note() << "Cycle() [read, error value again]";
     SerialClient->Cycle();
 }
 
@@ -990,7 +1003,7 @@ void TSerialClientIntegrationTest::SetUp()
                         DeviceFactory,
                         configSchema,
                         t,
-                        [=](const Json::Value&) {return std::make_pair(Port, false);});
+                        [=](const Json::Value&, size_t) {return std::make_pair(Port, false);});
 }
 
 void TSerialClientIntegrationTest::TearDown()
@@ -1368,27 +1381,27 @@ TEST_F(TSerialClientIntegrationTest, SlaveIdCollision)
                                         DeviceFactory,
                                         configSchema,
                                         t,
-                                        [=](const Json::Value&) {return std::make_pair(Port, false);}),
+                                        [=](const Json::Value&, size_t) {return std::make_pair(Port, false);}),
                     TConfigParserException);
 
     EXPECT_THROW(LoadConfig(GetDataFilePath("configs/config-collision-test2.json"), 
                                         DeviceFactory,
                                         configSchema,
                                         t,
-                                        [=](const Json::Value&) {return std::make_pair(Port, false);}),
+                                        [=](const Json::Value&, size_t) {return std::make_pair(Port, false);}),
                     TConfigParserException);
 
     EXPECT_NO_THROW(LoadConfig(GetDataFilePath("configs/config-no-collision-test.json"), 
                                         DeviceFactory,
                                         configSchema,
                                         t,
-                                        [=](const Json::Value&) {return std::make_pair(Port, false);}));
+                                        [=](const Json::Value&, size_t) {return std::make_pair(Port, false);}));
 
     EXPECT_NO_THROW(LoadConfig(GetDataFilePath("configs/config-no-collision-test2.json"), 
                                         DeviceFactory,
                                         configSchema,
                                         t,
-                                        [=](const Json::Value&) {return std::make_pair(Port, false);}));
+                                        [=](const Json::Value&, size_t) {return std::make_pair(Port, false);}));
 }
 
 /** Reconnect test cases **/
@@ -1414,7 +1427,7 @@ PMQTTSerialDriver TSerialClientIntegrationTest::StartReconnectTest1Device(bool m
                                             DeviceFactory,
                                             configSchema,
                                             t,
-                                            [=](const Json::Value&) {return std::make_pair(Port, false);});
+                                            [=](const Json::Value&, size_t) {return std::make_pair(Port, false);});
 
     if (pollIntervalTest) {
         Config->PortConfigs[0]->Devices[0]->DeviceConfig()->DeviceChannelConfigs[0]->RegisterConfigs[0]->PollInterval = chrono::seconds(100);
@@ -1516,7 +1529,7 @@ PMQTTSerialDriver TSerialClientIntegrationTest::StartReconnectTest2Devices()
                                             DeviceFactory,
                                             configSchema,
                                             t,
-                                            [=](const Json::Value&) {return std::make_pair(Port, false);});
+                                            [=](const Json::Value&, size_t) {return std::make_pair(Port, false);});
 
     PMQTTSerialDriver mqttDriver = make_shared<TMQTTSerialDriver>(Driver, Config);
 
@@ -142,6 +142,28 @@ TEST_F(TConfigParserTest, Parse)
     }
 }
 
+TEST_F(TConfigParserTest, MultipleConnections)
+{
+    Json::Value configSchema = LoadConfigSchema(GetDataFilePath("../wb-mqtt-serial.schema.json"));
+    TTemplateMap templateMap(GetDataFilePath("device-templates/"),
+                             LoadConfigTemplatesSchema(GetDataFilePath("../wb-mqtt-serial-device-template.schema.json"),
+                                                       configSchema));
+
+    PHandlerConfig config = LoadConfig(GetDataFilePath("configs/config-tcp-connections-test.json"),
+                                       DeviceFactory,
+                                       configSchema,
+                                       templateMap);
+
+    for (auto port_config: config->PortConfigs) {
+        Emit() << "Port: " << port_config->Port->GetDescription();
+        TTestLogIndent indent(*this);
+        for (auto device: port_config->Devices) {
+            Emit() << device->DeviceConfig()->Id;
+            EXPECT_EQ(port_config->Port, device->Port());
+        }
+    }
+}
+
 TEST_F(TConfigParserTest, UnsuccessfulParse)
 {
     Json::Value configSchema = LoadConfigSchema(GetDataFilePath("../wb-mqtt-serial.schema.json"));
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tcp_port.h"
+#include "serial_exc.h"
+
+namespace
+{
+    const auto ConnectionWaitTimeout = std::chrono::milliseconds(2000);
+}
+
+class TTcpPortTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ListenFd = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_GE(ListenFd, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(0, bind(ListenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+        socklen_t len = sizeof(addr);
+        ASSERT_EQ(0, getsockname(ListenFd, reinterpret_cast<sockaddr*>(&addr), &len));
+        ASSERT_EQ(0, listen(ListenFd, 1));
+        ListenPort = ntohs(addr.sin_port);
+        Port = std::make_shared<TTcpPort>(TTcpPortSettings("127.0.0.1", ListenPort));
+    }
+
+    void TearDown() override
+    {
+        Port.reset();
+        close(ListenFd);
+    }
+
+    //! Open the port and accept its connection
+    int Connect()
+    {
+        Port->Open();
+        if (!Port->IsOpen()) {
+            Port->WaitForOpen(ConnectionWaitTimeout);
+            Port->Open();
+        }
+        EXPECT_TRUE(Port->IsOpen());
+        return accept(ListenFd, nullptr, nullptr);
+    }
+
+    int                       ListenFd;
+    uint16_t                  ListenPort;
+    std::shared_ptr<TTcpPort> Port;
+};
+
+TEST_F(TTcpPortTest, Connect)
+{
+    auto fd = Connect();
+    ASSERT_GE(fd, 0);
+
+    uint8_t request[] = {0x01, 0x03};
+    Port->WriteBytes(request, sizeof(request));
+    uint8_t buf[10];
+    ASSERT_EQ(2, read(fd, buf, sizeof(buf)));
+    ASSERT_EQ(2, write(fd, request, sizeof(request)));
+    EXPECT_EQ(2u, Port->ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)));
+    close(fd);
+}
+
+TEST_F(TTcpPortTest, AdaptiveLag)
+{
+    auto fd = Connect();
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(0, Port->GetRoundTripTime().count());
+
+    uint8_t request[] = {0x01, 0x03};
+    uint8_t buf[10];
+    std::chrono::steady_clock::duration readTime;
+    for (int i = 0; i < 10; ++i) {
+        Port->WriteBytes(request, sizeof(request));
+        ASSERT_EQ(2, read(fd, buf, sizeof(buf)));
+        ASSERT_EQ(2, write(fd, request, sizeof(request)));
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(2u, Port->ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)));
+        readTime = std::chrono::steady_clock::now() - start;
+    }
+    EXPECT_GT(Port->GetRoundTripTime().count(), 0);
+    EXPECT_LT(Port->GetRoundTripTime(), std::chrono::milliseconds(50));
+
+    // Frame end is detected without waiting for maximum lag
+    EXPECT_LT(readTime, std::chrono::milliseconds(100));
+    close(fd);
+}
+
+TEST_F(TTcpPortTest, FrameLagSettings)
+{
+    // Default maximum frame lag is used until round trip time is measured, so it would delay frame end detection
+    TTcpPortSettings settings("127.0.0.1", ListenPort);
+    settings.MinFrameLag = std::chrono::milliseconds(0);
+    settings.MaxFrameLag = std::chrono::milliseconds(0);
+    Port = std::make_shared<TTcpPort>(settings);
+    auto fd = Connect();
+    ASSERT_GE(fd, 0);
+
+    uint8_t request[] = {0x01, 0x03};
+    uint8_t buf[10];
+    Port->WriteBytes(request, sizeof(request));
+    ASSERT_EQ(2, read(fd, buf, sizeof(buf)));
+    ASSERT_EQ(2, write(fd, request, sizeof(request)));
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(2u, Port->ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    close(fd);
+}
+
+TEST_F(TTcpPortTest, ReconnectInBackground)
+{
+    auto fd = Connect();
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    uint8_t buf[10];
+    EXPECT_THROW(Port->ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(100), std::chrono::milliseconds(10)),
+                 TSerialDeviceTransientErrorException);
+    EXPECT_FALSE(Port->IsOpen());
+
+    // Connection is already requested by the port
+    auto start = std::chrono::steady_clock::now();
+    Port->WaitForOpen(ConnectionWaitTimeout);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, ConnectionWaitTimeout);
+    Port->Open();
+    EXPECT_TRUE(Port->IsOpen());
+    fd = accept(ListenFd, nullptr, nullptr);
+    ASSERT_GE(fd, 0);
+    close(fd);
+}
+
+TEST_F(TTcpPortTest, ConnectionRefused)
+{
+    close(ListenFd);
+    ListenFd = -1;
+
+    Port->Open();
+    EXPECT_FALSE(Port->IsOpen());
+    Port->WaitForOpen(std::chrono::milliseconds(300));
+    Port->Open();
+    EXPECT_FALSE(Port->IsOpen());
+}
+
+TEST_F(TTcpPortTest, ReopenDoesNotBlock)
+{
+    auto fd = Connect();
+    ASSERT_GE(fd, 0);
+    close(fd);
+    close(ListenFd);
+    ListenFd = -1;
+
+    // New connection can't be established, but the port thread must not wait for it
+    auto start = std::chrono::steady_clock::now();
+    Port->Reopen();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_FALSE(Port->IsOpen());
+}
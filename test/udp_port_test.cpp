@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "udp_port.h"
+#include "serial_exc.h"
+
+namespace
+{
+    // Long frame timeout makes waiting for it noticeable
+    const auto FrameTimeout = std::chrono::milliseconds(500);
+    const auto ResponseTimeout = std::chrono::milliseconds(1000);
+}
+
+class TUdpPortTest: public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ServerFd = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_GE(ServerFd, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(0, bind(ServerFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+        socklen_t len = sizeof(addr);
+        ASSERT_EQ(0, getsockname(ServerFd, reinterpret_cast<sockaddr*>(&addr), &len));
+        Port = std::make_shared<TUdpPort>(TUdpPortSettings("127.0.0.1", ntohs(addr.sin_port)));
+        Port->Open();
+        ASSERT_TRUE(Port->IsOpen());
+    }
+
+    void TearDown() override
+    {
+        Port.reset();
+        close(ServerFd);
+    }
+
+    //! Receive request from the port and remember its address for replies
+    ssize_t Receive(uint8_t* buf, size_t size)
+    {
+        ClientAddrLen = sizeof(ClientAddr);
+        return recvfrom(ServerFd, buf, size, 0, reinterpret_cast<sockaddr*>(&ClientAddr), &ClientAddrLen);
+    }
+
+    ssize_t Reply(const uint8_t* buf, size_t size)
+    {
+        return sendto(ServerFd, buf, size, 0, reinterpret_cast<sockaddr*>(&ClientAddr), ClientAddrLen);
+    }
+
+    int                       ServerFd;
+    sockaddr_in               ClientAddr;
+    socklen_t                 ClientAddrLen;
+    std::shared_ptr<TUdpPort> Port;
+};
+
+TEST_F(TUdpPortTest, Datagram)
+{
+    uint8_t request[] = {0x01, 0x03, 0x00};
+    Port->WriteBytes(request, sizeof(request));
+    uint8_t buf[10];
+    ASSERT_EQ(3, Receive(buf, sizeof(buf)));
+
+    ASSERT_EQ(3, Reply(request, sizeof(request)));
+    ASSERT_EQ(2, Reply(request, 2));
+
+    // Every datagram is a separate frame, no waiting for frame timeout
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(3u, Port->ReadFrame(buf, sizeof(buf), ResponseTimeout, FrameTimeout));
+    EXPECT_EQ(2u, Port->ReadFrame(buf, sizeof(buf), ResponseTimeout, FrameTimeout));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, FrameTimeout);
+}
+
+TEST_F(TUdpPortTest, SplitFrame)
+{
+    uint8_t request[] = {0x01, 0x03, 0x00, 0x04};
+    Port->WriteBytes(request, sizeof(request));
+    uint8_t buf[10];
+    ASSERT_EQ(4, Receive(buf, sizeof(buf)));
+
+    ASSERT_EQ(2, Reply(request, 2));
+    ASSERT_EQ(2, Reply(request + 2, 2));
+
+    // The frame is continued in next datagram until the predicate is satisfied
+    auto start = std::chrono::steady_clock::now();
+    auto size = Port->ReadFrame(buf, sizeof(buf), ResponseTimeout, FrameTimeout, [](uint8_t* buf, int size) {
+        return size >= 4;
+    });
+    EXPECT_EQ(4u, size);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, FrameTimeout);
+    EXPECT_EQ(0, memcmp(request, buf, sizeof(request)));
+}
+
+TEST_F(TUdpPortTest, Timeout)
+{
+    uint8_t buf[10];
+    EXPECT_THROW(Port->ReadFrame(buf, sizeof(buf), std::chrono::milliseconds(10), FrameTimeout),
+                 TSerialDeviceTransientErrorException);
+}